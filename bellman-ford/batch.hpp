@@ -0,0 +1,251 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+#include "../common/graph.hpp"
+#include "../common/engine.hpp"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Пакетный Bellman-Ford: за один проход по графу считаются расстояния
+// от Lanes источников. Расстояния хранятся по вершинам с чередованием
+// источников (dist[v * Lanes + l]), поэтому релаксация ребра — это одно
+// векторное сложение и минимум по всем полосам, а чтение графа делится
+// между источниками пакета.
+// Раунд работает по фронту: кандидаты — исходящие соседи вершин,
+// изменившихся в прошлом раунде. Каждый кандидат собирает минимум по
+// входящим ребрам из фронта (pull) в свой слот буфера, затем слоты
+// переносятся в dist. Каждая вершина пишет только свои полосы, поэтому
+// оба шага параллелятся без атомарных операций.
+template <int Lanes>
+class BellmanFordBatch : public SsspEngine {
+    CSRGraph graph;
+    CSRGraph incoming;
+    std::vector<int> dist;
+    std::vector<int> candidate_dist;
+    std::vector<char> in_frontier;
+    std::vector<char> is_candidate;
+    std::vector<char> improved;
+    std::vector<int> frontier;
+    std::vector<int> candidates;
+    std::vector<int> single;
+
+public:
+    BellmanFordBatch(const CSRGraph& graph, const EngineOptions&)
+        : graph(graph), incoming(graph.transpose()),
+          dist(static_cast<size_t>(graph.get_vertices()) * Lanes), candidate_dist(dist.size()),
+          in_frontier(graph.get_vertices(), 0), is_candidate(graph.get_vertices(), 0),
+          improved(graph.get_vertices()), single(graph.get_vertices()) {
+        frontier.reserve(graph.get_vertices());
+        candidates.reserve(graph.get_vertices());
+    }
+
+    // Релаксация ребра считается один раз на все полосы пакета
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        run(&source, 1);
+        extract(0, single.data());
+        return single;
+    }
+
+    void solve_batch(const std::vector<int>& sources, std::vector<int>& out) override {
+        size_t vertices = graph.get_vertices();
+        for (size_t first = 0; first < sources.size(); first += Lanes) {
+            int count = static_cast<int>(std::min<size_t>(Lanes, sources.size() - first));
+            for (int l = 0; l < count; ++l) {
+                check_source(graph, sources[first + l]);
+            }
+            run(sources.data() + first, count);
+            for (int l = 0; l < count; ++l) {
+                extract(l, out.data() + (first + l) * vertices);
+            }
+        }
+    }
+
+private:
+    // Пакет из count <= Lanes источников, свободные полосы остаются INF
+    void run(const int* sources, int count) {
+        int vertices = graph.get_vertices();
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const size_t* in_offsets = incoming.offsets();
+        const int* in_sources = incoming.targets();
+        const int* in_weights = incoming.weights();
+        int* dist_ptr = dist.data();
+        int* candidate_ptr = candidate_dist.data();
+        const char* in_frontier_ptr = in_frontier.data();
+        char* improved_ptr = improved.data();
+
+        std::fill(dist.begin(), dist.end(), INF);
+        frontier.clear();
+        for (int l = 0; l < count; ++l) {
+            dist[static_cast<size_t>(sources[l]) * Lanes + l] = 0;
+            if (!in_frontier[sources[l]]) {
+                in_frontier[sources[l]] = 1;
+                frontier.push_back(sources[l]);
+            }
+        }
+
+        #ifdef _OPENMP
+        bool parallel = omp_get_max_threads() > 1;
+        #else
+        bool parallel = false;
+        #endif
+        if (!parallel) {
+            run_push();
+            return;
+        }
+
+        for (int i = 0; i < vertices - 1 && !frontier.empty(); ++i) {
+            SSSP_COUNT(work.phase(frontier.size()));
+            candidates.clear();
+            for (int u : frontier) {
+                for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                    int v = targets[e];
+                    if (!is_candidate[v]) {
+                        is_candidate[v] = 1;
+                        candidates.push_back(v);
+                    }
+                }
+            }
+            const int* candidates_ptr = candidates.data();
+            int candidates_count = static_cast<int>(candidates.size());
+
+            // Минимум по входящим ребрам из фронта; dist только читается
+            #pragma omp parallel for schedule(dynamic, 64)
+            for (int j = 0; j < candidates_count; ++j) {
+                int v = candidates_ptr[j];
+                const int* dist_v = dist_ptr + static_cast<size_t>(v) * Lanes;
+                SSSP_COUNT(ThreadWork& counted = work.current());
+                int best[Lanes];
+                #pragma omp simd
+                for (int l = 0; l < Lanes; ++l) {
+                    best[l] = dist_v[l];
+                }
+
+                for (size_t e = in_offsets[v]; e < in_offsets[v + 1]; ++e) {
+                    int u = in_sources[e];
+                    if (!in_frontier_ptr[u]) {
+                        continue;
+                    }
+                    SSSP_COUNT(++counted.relax_attempts);
+                    // Полосы без пути маскируются выбором, а не ветвлением,
+                    // чтобы отрицательный вес не уменьшал INF
+                    const int* dist_u = dist_ptr + static_cast<size_t>(u) * Lanes;
+                    int w = in_weights[e];
+                    #pragma omp simd
+                    for (int l = 0; l < Lanes; ++l) {
+                        int candidate = dist_u[l] < INF ? dist_u[l] + w : INF;
+                        best[l] = std::min(best[l], candidate);
+                    }
+                }
+
+                int differs = 0;
+                int* slot = candidate_ptr + static_cast<size_t>(j) * Lanes;
+                #pragma omp simd reduction(|:differs)
+                for (int l = 0; l < Lanes; ++l) {
+                    differs |= best[l] != dist_v[l];
+                    slot[l] = best[l];
+                }
+                improved_ptr[j] = differs != 0;
+                SSSP_COUNT(counted.relax_success += differs != 0);
+            }
+
+            // Перенос улучшенных расстояний; вершины кандидатов различны
+            #pragma omp parallel for schedule(static)
+            for (int j = 0; j < candidates_count; ++j) {
+                if (improved_ptr[j]) {
+                    std::copy(candidate_ptr + static_cast<size_t>(j) * Lanes,
+                              candidate_ptr + static_cast<size_t>(j + 1) * Lanes,
+                              dist_ptr + static_cast<size_t>(candidates_ptr[j]) * Lanes);
+                }
+            }
+
+            for (int u : frontier) {
+                in_frontier[u] = 0;
+            }
+            frontier.clear();
+            for (int j = 0; j < candidates_count; ++j) {
+                is_candidate[candidates_ptr[j]] = 0;
+                if (improved_ptr[j]) {
+                    in_frontier[candidates_ptr[j]] = 1;
+                    frontier.push_back(candidates_ptr[j]);
+                }
+            }
+        }
+
+        for (int u : frontier) {
+            in_frontier[u] = 0;
+        }
+    }
+
+    // Последовательный раунд с проталкиванием: улучшения сразу видны
+    // следующим вершинам фронта (по Гауссу-Зейделю), входящие ребра не нужны
+    void run_push() {
+        int vertices = graph.get_vertices();
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+        int* dist_ptr = dist.data();
+
+        SSSP_COUNT(ThreadWork& counted = work.current());
+
+        for (int i = 0; i < vertices - 1 && !frontier.empty(); ++i) {
+            SSSP_COUNT(work.phase(frontier.size()));
+            candidates.clear();
+            for (int u : frontier) {
+                in_frontier[u] = 0;
+            }
+            for (int u : frontier) {
+                const int* dist_u = dist_ptr + static_cast<size_t>(u) * Lanes;
+                SSSP_COUNT(counted.relax_attempts += offsets[u + 1] - offsets[u]);
+                for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                    int v = targets[e];
+                    int w = weights[e];
+                    int* dist_v = dist_ptr + static_cast<size_t>(v) * Lanes;
+                    int differs = 0;
+                    #pragma omp simd reduction(|:differs)
+                    for (int l = 0; l < Lanes; ++l) {
+                        int candidate = dist_u[l] < INF ? dist_u[l] + w : INF;
+                        differs |= candidate < dist_v[l];
+                        dist_v[l] = std::min(dist_v[l], candidate);
+                    }
+                    SSSP_COUNT(counted.relax_success += differs != 0);
+                    if (differs && !is_candidate[v]) {
+                        is_candidate[v] = 1;
+                        candidates.push_back(v);
+                    }
+                }
+            }
+            for (int v : candidates) {
+                is_candidate[v] = 0;
+            }
+            frontier.swap(candidates);
+        }
+    }
+
+    void extract(int lane, int* out) const {
+        int vertices = graph.get_vertices();
+        for (int v = 0; v < vertices; ++v) {
+            out[v] = dist[static_cast<size_t>(v) * Lanes + lane];
+        }
+    }
+};
+
+// Выбор ширины пакета по EngineOptions::lanes
+inline EngineHandle prepare_batch(const CSRGraph& graph, const EngineOptions& options) {
+    switch (options.lanes) {
+        case 8:
+            return std::make_unique<BellmanFordBatch<8>>(graph, options);
+        case 16:
+            return std::make_unique<BellmanFordBatch<16>>(graph, options);
+        case 32:
+            return std::make_unique<BellmanFordBatch<32>>(graph, options);
+        default:
+            throw std::invalid_argument("Batch lanes must be 8, 16 or 32");
+    }
+}
@@ -2,28 +2,28 @@ import subprocess
 import matplotlib.pyplot as plt
 import numpy as np
 from pathlib import Path
-import re
 import json
 import os
 
-def run_benchmark(executable, vertices, prob, save=False):
+def run_benchmark(executable, vertices, prob, save=False, impl=None):
     cmd = [f"./{executable}"]
-    cmd.extend(["--vertices", str(vertices), "--prob", str(prob)])
+    cmd.extend(["--vertices", str(vertices), "--prob", str(prob), "--seed", "1"])
     if save:
         cmd.extend(["--save"])
     else:
         cmd.extend(["graph.txt"])
-    
+    if impl:
+        cmd.extend(["--impl", impl])
+    cmd.extend(["--warmup", "2", "--repeat", "10", "--output", "run.json"])
+
     result = subprocess.run(cmd, capture_output=True, text=True, check=True)
-    # Ищем все времена выполнения в выводе программы
-    times = re.findall(r'реализация: (\d+\.\d+) секунд', result.stdout)
-    if times:
-        times = [float(t) for t in times]
-        times.sort()
-        times = times[2:-2]
-        return np.mean(times)
-    else:
-        print(f"Не удалось найти время выполнения в выводе {executable}")
+    # Программа сама считает статистику по повторам и пишет ее в JSON
+    try:
+        with open("run.json") as f:
+            records = json.load(f)
+        return records[0]["median"]
+    except (OSError, ValueError, IndexError, KeyError):
+        print(f"Не удалось прочитать результаты замера {executable}")
         print("Вывод программы:", result.stdout)
         return None
 
@@ -38,7 +38,7 @@ def load_existing_results(filename='results.json'):
     return {}
 
 def calculate_speedup(cpp_times, parallel_times):
-    """Вычисляет ускорение параллельной реализации относительно C++"""
+    """Вычисляет ускорение параллельной реализации относительно алгоритма Дейкстры"""
     if len(cpp_times) != len(parallel_times):
         return None
     speedups = []
@@ -53,7 +53,7 @@ def calculate_speedup(cpp_times, parallel_times):
 def main():
     # Список исполняемых файлов
     executables = ['main-cpp.o', 'main-dpc-cpu.o', 'main-dpc-gpu.o', 'main-openmp-cpu.o', 'main-openmp-gpu.o']
-    labels = ['C++', 'DPC++ CPU', 'DPC++ CPU+GPU', 'OpenMP CPU', 'OpenMP CPU+GPU']
+    labels = ['Dijkstra', 'DPC++ CPU', 'DPC++ CPU+GPU', 'OpenMP CPU', 'OpenMP CPU+GPU']
     
     # Создаем директории для результатов
     Path('benchmarks').mkdir(exist_ok=True)
@@ -102,8 +102,8 @@ def main():
                 for i, exe in enumerate(executables):
                     print(f"Тестирование {exe} для {v} вершин")
                     
-                    if i == 0:  # Для первой реализации сохраняем граф
-                        avg = run_benchmark(exe, v, prob, save=True)
+                    if i == 0:  # Эталон — алгоритм Дейкстры из main-cpp.o, для него сохраняем граф
+                        avg = run_benchmark(exe, v, prob, save=True, impl="dijkstra")
                     else:
                         avg = run_benchmark(exe, v, prob)
                     
@@ -141,7 +141,7 @@ def main():
         # Создаем график ускорения
         plt.figure(figsize=(12, 8))
         
-        # Вычисляем ускорение для каждой параллельной реализации относительно C++
+        # Вычисляем ускорение для каждой параллельной реализации относительно Дейкстры
         cpp_times = avgs[0]  # Время C++ реализации
         speedup_labels = ['DPC++ CPU', 'DPC++ CPU+GPU', 'OpenMP CPU', 'OpenMP CPU+GPU']
         
@@ -151,7 +151,7 @@ def main():
             if speedups:
                 plt.plot(vertices, speedups, label=speedup_labels[i-1], marker='o', linewidth=2)
         
-        plt.axhline(y=1, color='black', linestyle='--', alpha=0.5, label='C++')
+        plt.axhline(y=1, color='black', linestyle='--', alpha=0.5, label='Dijkstra')
         
         # Настраиваем график ускорения
         plt.xlabel('Количество вершин')
@@ -1,14 +1,26 @@
 #include <vector>
 #include "../common/graph.hpp"
+#include "../common/dijkstra.hpp"
 #include "task.hpp"
 #include "cpp.hpp"
+#include "batch.hpp"
+#include "simd.hpp"
+#include "negative_cycle.hpp"
 
 int main(int argc, char* argv[]) {
-    Task task({Impl{bellman_ford_cpp, "C++"}});
-    // Task task({Impl{bellman_ford_cpp, "C++"}, Impl{bellman_ford_cpp, "C++"}});
-    task.init(argc, argv);
-    for (int i = 0; i < 10; i++) {
-        task.run();
+    Task task({
+        Impl{prepare<BellmanFordCpp>, "C++", "cpp"},
+        Impl{prepare<BellmanFordFrontierCpp>, "C++ Frontier", "frontier"},
+        Impl{prepare_compact<BasicBellmanFordFrontier>, "C++ Compact", "compact"},
+        Impl{prepare_batch, "C++ Batch", "batch"},
+        Impl{prepare<BellmanFordSimd>, "C++ SIMD", "simd"},
+        Impl{prepare<BellmanFordGoldbergRadzik>, "C++ GR-Tarjan", "negative"},
+        Impl{prepare<BellmanFordSymmetric>, "C++ Symmetric", "symmetric"},
+        Impl{prepare_dijkstra, "Dijkstra", "dijkstra"}
+    });
+    int status = task.init(argc, argv);
+    if (status != 0) {
+        return status == Task::DONE ? 0 : status;
     }
-    return 0;
+    return task.benchmark();
 }
@@ -1,33 +1,199 @@
 #pragma once
 
+#include <algorithm>
 #include <vector>
 #include "../common/graph.hpp"
+#include "../common/engine.hpp"
+#include "../common/compact_graph.hpp"
 
-std::vector<int> bellman_ford_cpp(int vertices, std::vector<Edge> edges, int source, std::chrono::duration<double>& duration) {
-    std::vector<int> dist(vertices, INF);
-    dist[source] = 0;
-
-    bool changed = true;
-
-    auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < vertices - 1 && changed; ++i) {
-        changed = false;
-        for (const auto& edge : edges) {
-            int u = edge.from;
-            int v = edge.to;
-            int w = edge.weight;
-            if (dist[u] < INF && dist[u] + w < dist[v]) {
-                dist[v] = dist[u] + w;
-                changed = true;
+class BellmanFordCpp : public SsspEngine {
+    CSRGraph graph;
+    std::vector<int> dist;
+
+public:
+    BellmanFordCpp(const CSRGraph& graph, const EngineOptions&) : graph(graph), dist(graph.get_vertices()) {}
+
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int vertices = graph.get_vertices();
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+
+        std::fill(dist.begin(), dist.end(), INF);
+        dist[source] = 0;
+        SSSP_COUNT(ThreadWork& counted = work.current());
+
+        bool changed = true;
+        for (int i = 0; i < vertices - 1 && changed; ++i) {
+            changed = false;
+            SSSP_COUNT(size_t scanned = 0);
+            for (int u = 0; u < vertices; ++u) {
+                int dist_u = dist[u];
+                if (dist_u >= INF) {
+                    continue;
+                }
+                SSSP_COUNT(++scanned; counted.relax_attempts += offsets[u + 1] - offsets[u]);
+                for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                    int v = targets[e];
+                    int w = weights[e];
+                    if (dist_u + w < dist[v]) {
+                        SSSP_COUNT(++counted.relax_success; counted.reinsertions += dist[v] < INF);
+                        dist[v] = dist_u + w;
+                        changed = true;
+                    }
+                }
             }
+            SSSP_COUNT(work.phase(scanned));
         }
 
-        if (!changed) {
-            break;
-        }
+        return dist;
     }
-    auto stop = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+};
 
-    return dist;
+// Одна копия ребер для движков BellmanFordSymmetric*. Ориентированный
+// граф им не подходит: Task пропускает их, остальные реализации работают
+inline CSRGraph symmetric_single_copy(const CSRGraph& graph) {
+    if (!graph.is_symmetric()) {
+        throw UnsupportedGraph("Graph is directed: every edge needs a reverse edge of the same weight");
+    }
+    return graph.single_copy();
 }
+
+// Bellman-Ford на неориентированном графе с одной копией каждого ребра
+// (CSRGraph::single_copy): за проход ребро {u, v} читается один раз и
+// релаксируется в обе стороны, поэтому памяти под ребра и чтений ребер
+// за проход вдвое меньше, чем у BellmanFordCpp на дугах в обе стороны.
+// Проход релаксирует каждую дугу, так что оценка в V - 1 проход
+// сохраняется. На ориентированном графе подготовка бросает UnsupportedGraph.
+class BellmanFordSymmetric : public SsspEngine {
+    CSRGraph graph;
+    std::vector<int> dist;
+
+public:
+    BellmanFordSymmetric(const CSRGraph& graph, const EngineOptions&)
+        : graph(symmetric_single_copy(graph)), dist(graph.get_vertices()) {}
+
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int vertices = graph.get_vertices();
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+
+        std::fill(dist.begin(), dist.end(), INF);
+        dist[source] = 0;
+        SSSP_COUNT(ThreadWork& counted = work.current());
+
+        bool changed = true;
+        for (int i = 0; i < vertices - 1 && changed; ++i) {
+            changed = false;
+            for (int u = 0; u < vertices; ++u) {
+                int dist_u = dist[u];
+                SSSP_COUNT(counted.relax_attempts += 2 * (offsets[u + 1] - offsets[u]));
+                for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                    int v = targets[e];
+                    int w = weights[e];
+                    int dist_v = dist[v];
+                    if (dist_u < INF && dist_u + w < dist_v) {
+                        SSSP_COUNT(++counted.relax_success; counted.reinsertions += dist_v < INF);
+                        dist[v] = dist_u + w;
+                        changed = true;
+                    } else if (dist_v < INF && dist_v + w < dist_u) {
+                        SSSP_COUNT(++counted.relax_success; counted.reinsertions += dist_u < INF);
+                        dist_u = dist[u] = dist_v + w;
+                        changed = true;
+                    }
+                }
+            }
+            SSSP_COUNT(work.phase(vertices));
+        }
+
+        return dist;
+    }
+};
+
+// Bellman-Ford по фронту (SPFA по раундам): в каждом раунде релаксируются
+// только исходящие ребра вершин, расстояние до которых изменилось в прошлом
+// раунде. Стоимость раунда пропорциональна активному множеству, а не |E|.
+// Раундов не больше V - 1, как и у полного перебора ребер.
+// Граф и тип расстояний — параметры шаблона: CSRGraph с int или
+// CompactCSRGraph с узкими типами (см. prepare_compact).
+// С EngineOptions::parents улучшение расстояния запоминает и предка.
+template <typename Graph, typename Distance>
+class BasicBellmanFordFrontier : public SsspEngine {
+    Graph graph;
+    std::vector<Distance> dist;
+    std::vector<char> in_next;
+    std::vector<int> frontier;
+    std::vector<int> next_frontier;
+    std::vector<int> result;
+    std::vector<int> parent; // пусто, если предки не нужны
+
+public:
+    BasicBellmanFordFrontier(const CSRGraph& graph, const EngineOptions& options)
+        : graph(graph), dist(graph.get_vertices()), in_next(graph.get_vertices(), 0),
+          parent(options.parents ? graph.get_vertices() : 0) {
+        frontier.reserve(graph.get_vertices());
+        next_frontier.reserve(graph.get_vertices());
+    }
+
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>* parents() override {
+        return parent.empty() ? nullptr : &parent;
+    }
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int vertices = graph.get_vertices();
+        const auto* offsets = graph.offsets();
+        const auto* targets = graph.targets();
+        const auto* weights = graph.weights();
+
+        std::fill(dist.begin(), dist.end(), distance_inf<Distance>());
+        std::fill(parent.begin(), parent.end(), -1);
+        dist[source] = 0;
+        frontier.clear();
+        frontier.push_back(source);
+        bool track_parents = !parent.empty();
+        SSSP_COUNT(ThreadWork& counted = work.current());
+
+        for (int i = 0; i < vertices - 1 && !frontier.empty(); ++i) {
+            SSSP_COUNT(work.phase(frontier.size()));
+            for (int u : frontier) {
+                Distance dist_u = dist[u];
+                SSSP_COUNT(counted.relax_attempts += offsets[u + 1] - offsets[u]);
+                for (auto e = offsets[u]; e < offsets[u + 1]; ++e) {
+                    int v = static_cast<int>(targets[e]);
+                    Distance candidate = dist_u + static_cast<Distance>(weights[e]);
+                    if (candidate < dist[v]) {
+                        SSSP_COUNT(++counted.relax_success; counted.reinsertions += dist[v] < distance_inf<Distance>());
+                        dist[v] = candidate;
+                        if (track_parents) {
+                            parent[v] = u;
+                        }
+                        if (!in_next[v]) {
+                            in_next[v] = 1;
+                            next_frontier.push_back(v);
+                        }
+                    }
+                }
+            }
+
+            for (int v : next_frontier) {
+                in_next[v] = 0;
+            }
+            frontier.swap(next_frontier);
+            next_frontier.clear();
+        }
+
+        return export_distances(dist, result);
+    }
+};
+
+using BellmanFordFrontierCpp = BasicBellmanFordFrontier<CSRGraph, int>;
@@ -1,33 +1,31 @@
 #include <sycl/sycl.hpp>
 #include <vector>
 #include "../common/graph.hpp"
+#include "../common/dijkstra.hpp"
 #include "task.hpp"
 #include "cpp.hpp"
 #include "dpc.hpp"
 
-std::vector<int> bellman_ford_dpc_cpu(int vertices, std::vector<Edge> edges, int source, std::chrono::duration<double>& duration) {
-    sycl::queue q{sycl::cpu_selector_v};
-    return bellman_ford_dpc(vertices, edges, source, duration, q);
+EngineHandle prepare_dpc_cpu(const CSRGraph& graph, const EngineOptions&) {
+    return std::make_unique<BellmanFordDPC>(graph, sycl::queue{sycl::cpu_selector_v});
 }
 
-std::vector<int> bellman_ford_dpc_gpu(int vertices, std::vector<Edge> edges, int source, std::chrono::duration<double>& duration) {
-    sycl::queue q{sycl::gpu_selector_v};
-    return bellman_ford_dpc(vertices, edges, source, duration, q);
+EngineHandle prepare_dpc_gpu(const CSRGraph& graph, const EngineOptions&) {
+    return std::make_unique<BellmanFordDPC>(graph, sycl::queue{sycl::gpu_selector_v});
 }
 
 int main(int argc, char* argv[]) {
     Impl impl;
     #ifdef DPC_CPU
-    impl = Impl{bellman_ford_dpc_cpu, "DPC++ CPU"};
+    impl = Impl{prepare_dpc_cpu, "DPC++ CPU", "dpc"};
     #else
-    impl = Impl{bellman_ford_dpc_gpu, "DPC++ GPU"};
+    impl = Impl{prepare_dpc_gpu, "DPC++ GPU", "dpc"};
     #endif
 
-    Task task({impl});
-    // Task task({Impl{bellman_ford_cpp, "C++"}, impl});
-    task.init(argc, argv);
-    for (int i = 0; i < 10; i++) {
-        task.run();
+    Task task({impl, Impl{prepare<BellmanFordCpp>, "C++", "cpp"}, Impl{prepare_dijkstra, "Dijkstra", "dijkstra"}});
+    int status = task.init(argc, argv);
+    if (status != 0) {
+        return status == Task::DONE ? 0 : status;
     }
-    return 0;
-}
\ No newline at end of file
+    return task.benchmark();
+}
@@ -1,53 +1,100 @@
 #include <sycl/sycl.hpp>
+#include <algorithm>
 #include <vector>
 #include "../common/graph.hpp"
+#include "../common/engine.hpp"
 
-std::vector<int> bellman_ford_dpc(int vertices, std::vector<Edge> edges, int source, std::chrono::duration<double>& duration, sycl::queue q) {
-    std::vector<int> dist(vertices, INF);
-    dist[source] = 0;
+// Граф копируется на устройство один раз при подготовке,
+// между запросами передаются только расстояния
+class BellmanFordDPC : public SsspEngine {
+    CSRGraph graph;
+    sycl::queue q;
+    std::vector<int> dist;
+    int* dist_device;
+    size_t* offsets_device;
+    int* targets_device;
+    int* weights_device;
+    int* changed;
 
-    int *dist_device = sycl::malloc_device<int>(vertices, q);
-    q.memcpy(dist_device, dist.data(), sizeof(int) * vertices);
+public:
+    BellmanFordDPC(const CSRGraph& graph, sycl::queue queue) : graph(graph), q(queue), dist(graph.get_vertices()) {
+        int vertices = graph.get_vertices();
+        size_t edges_size = graph.get_edges_count();
 
-    Edge *edges_device = sycl::malloc_device<Edge>(edges.size(), q);
-    q.memcpy(edges_device, edges.data(), sizeof(Edge) * edges.size());
+        dist_device = sycl::malloc_device<int>(vertices, q);
 
-    q.wait();
+        offsets_device = sycl::malloc_device<size_t>(vertices + 1, q);
+        q.memcpy(offsets_device, graph.offsets(), sizeof(size_t) * (vertices + 1));
 
-    int* changed = sycl::malloc_shared<int>(1, q);
-    changed[0] = 1;
+        targets_device = sycl::malloc_device<int>(edges_size, q);
+        q.memcpy(targets_device, graph.targets(), sizeof(int) * edges_size);
 
-    auto start = std::chrono::high_resolution_clock::now();
-    for (int i = 0; i < vertices - 1 && changed[0] == 1; ++i) {
-        q.submit([&](sycl::handler& h) {
-            changed[0] = 0;
+        weights_device = sycl::malloc_device<int>(edges_size, q);
+        q.memcpy(weights_device, graph.weights(), sizeof(int) * edges_size);
 
-            h.parallel_for(sycl::range<1>(edges.size()), [=](sycl::id<1> idx) {
-                int u = edges_device[idx].from;
-                int v = edges_device[idx].to;
-                int w = edges_device[idx].weight;
+        changed = sycl::malloc_shared<int>(1, q);
+        q.wait();
+    }
 
-                if (dist_device[u] < INF && dist_device[u] + w < dist_device[v]) {
-                    changed[0] = 1;
+    ~BellmanFordDPC() override {
+        sycl::free(offsets_device, q);
+        sycl::free(targets_device, q);
+        sycl::free(weights_device, q);
+        sycl::free(dist_device, q);
+        sycl::free(changed, q);
+    }
 
-                    sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device, sycl::access::address_space::global_space>
-                        atomic_dist_v(dist_device[v]);
-                    int old = atomic_dist_v.load();
-                    int new_val = dist_device[u] + w;
-                    while (old > new_val && !atomic_dist_v.compare_exchange_strong(old, new_val)) {}
-                }
-            });
-        });
+    // Ядро на устройстве не считает релаксации, отмечаются только раунды
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int vertices = graph.get_vertices();
+        int* dist_device = this->dist_device;
+        size_t* offsets_device = this->offsets_device;
+        int* targets_device = this->targets_device;
+        int* weights_device = this->weights_device;
+        int* changed = this->changed;
+
+        std::fill(dist.begin(), dist.end(), INF);
+        dist[source] = 0;
+        q.memcpy(dist_device, dist.data(), sizeof(int) * vertices);
         q.wait();
-    }
-    auto stop = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
 
-    q.memcpy(dist.data(), dist_device, sizeof(int) * vertices);
-    q.wait();
+        changed[0] = 1;
+        for (int i = 0; i < vertices - 1 && changed[0] == 1; ++i) {
+            q.submit([&](sycl::handler& h) {
+                changed[0] = 0;
 
-    sycl::free(edges_device, q);
-    sycl::free(dist_device, q);
-    sycl::free(changed, q);
-    return dist;
-}
+                h.parallel_for(sycl::range<1>(vertices), [=](sycl::id<1> idx) {
+                    int u = idx[0];
+                    int dist_u = dist_device[u];
+                    if (dist_u >= INF) {
+                        return;
+                    }
+
+                    for (size_t e = offsets_device[u]; e < offsets_device[u + 1]; ++e) {
+                        int v = targets_device[e];
+                        int w = weights_device[e];
+
+                        if (dist_u + w < dist_device[v]) {
+                            changed[0] = 1;
+
+                            sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device, sycl::access::address_space::global_space>
+                                atomic_dist_v(dist_device[v]);
+                            int old = atomic_dist_v.load();
+                            int new_val = dist_u + w;
+                            while (old > new_val && !atomic_dist_v.compare_exchange_strong(old, new_val)) {}
+                        }
+                    }
+                });
+            });
+            q.wait();
+            SSSP_COUNT(work.phase(vertices));
+        }
+
+        q.memcpy(dist.data(), dist_device, sizeof(int) * vertices);
+        q.wait();
+        return dist;
+    }
+};
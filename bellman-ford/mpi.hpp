@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdexcept>
+#include <vector>
+#include <mpi.h>
+#include "../common/graph.hpp"
+#include "../common/engine.hpp"
+#include "../common/distributed.hpp"
+
+// Распределенный Bellman-Ford по фронту: вершины делятся между процессами
+// блоками (distributed::Partition), каждый процесс хранит исходящие ребра
+// и расстояния только своих вершин. В раунде процесс релаксирует ребра
+// своего фронта: к своим вершинам сразу, к чужим — запросом, запросы
+// раунда уходят одним обменом (distributed::RelaxExchange). Раунды идут,
+// пока фронт не пуст хотя бы на одном процессе, но не больше V - 1.
+// В конце расстояния собираются на всех процессах.
+class BellmanFordMPI : public SsspEngine {
+    MPI_Comm comm = MPI_COMM_WORLD;
+    distributed::Partition partition;
+    CSRGraph rows;
+    distributed::RelaxExchange exchange;
+    std::vector<int> dist;
+    std::vector<char> in_next;
+    std::vector<int> frontier;
+    std::vector<int> next_frontier;
+    std::vector<int> result;
+    SSSP_COUNT(std::vector<long long> round_sizes;)
+
+    // Уменьшение расстояния своей вершины (локальный номер) с постановкой в следующий фронт
+    void improve(int local, int candidate SSSP_COUNT(, ThreadWork& counted)) {
+        if (candidate < dist[local]) {
+            SSSP_COUNT(++counted.relax_success; counted.reinsertions += dist[local] < INF);
+            dist[local] = candidate;
+            if (!in_next[local]) {
+                in_next[local] = 1;
+                next_frontier.push_back(local);
+            }
+        }
+    }
+
+public:
+    BellmanFordMPI(const CSRGraph& graph, const EngineOptions&)
+        : partition(distributed::Partition::block(graph.get_vertices(), comm)),
+          rows(distributed::local_rows(graph, partition)), exchange(partition, comm),
+          dist(partition.local_count()), in_next(partition.local_count(), 0) {}
+
+    // Релаксации считает каждый процесс, в конце запроса они собираются
+    // на процессе 0 по ячейке на процесс (distributed::add_counters)
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        if (source < 0 || source >= partition.vertices) {
+            throw std::out_of_range("Source vertex is out of range");
+        }
+        const size_t* offsets = rows.offsets();
+        const int* targets = rows.targets();
+        const int* weights = rows.weights();
+        int first = partition.first;
+
+        std::fill(dist.begin(), dist.end(), INF);
+        frontier.clear();
+        if (partition.owns(source)) {
+            dist[source - first] = 0;
+            frontier.push_back(source - first);
+        }
+        SSSP_COUNT(ThreadWork counted; round_sizes.clear());
+
+        for (int i = 0; i < partition.vertices - 1 && distributed::any(!frontier.empty(), comm); ++i) {
+            SSSP_COUNT(round_sizes.push_back(frontier.size()));
+            for (int u : frontier) {
+                int dist_u = dist[u];
+                SSSP_COUNT(counted.relax_attempts += offsets[u + 1] - offsets[u]);
+                for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                    int v = targets[e];
+                    if (partition.owns(v)) {
+                        improve(v - first, dist_u + weights[e] SSSP_COUNT(, counted));
+                    } else {
+                        exchange.push(v, dist_u + weights[e]);
+                    }
+                }
+            }
+            for (const distributed::Message& message : exchange.exchange()) {
+                improve(message.vertex - first, message.dist SSSP_COUNT(, counted));
+            }
+
+            for (int v : next_frontier) {
+                in_next[v] = 0;
+            }
+            frontier.swap(next_frontier);
+            next_frontier.clear();
+        }
+
+        SSSP_COUNT(distributed::add_counters(work, counted, round_sizes, partition, comm));
+        distributed::gather_distances(dist, partition, comm, result);
+        return result;
+    }
+};
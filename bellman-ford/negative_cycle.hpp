@@ -0,0 +1,204 @@
+#pragma once
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+#include "../common/graph.hpp"
+#include "../common/engine.hpp"
+#include "../common/negative_cycle.hpp"
+
+// Bellman-Ford для произвольных целых весов с ранним поиском
+// отрицательных циклов: вместо V - 1 полных раундов движок либо
+// возвращает расстояния, либо бросает NegativeCycleError со свидетелем.
+// Параллельный вариант — BellmanFordNegativeCycleOpenMP (openmp.hpp).
+//
+// Проходы Голдберга-Радзика и разборка поддеревьев Тарьяна.
+// Проход начинается с вершин, улучшенных в прошлом проходе: из них
+// обходом в глубину по ребрам с отрицательной приведенной стоимостью
+// (dist[u] + w < dist[v]) строится топологический порядок, и вершины
+// сканируются в нем, так что каждая вершина прохода видит уже улучшенных
+// предшественников. Замкнутый обход по таким ребрам — отрицательный цикл.
+// Дерево кратчайших путей хранится списком в порядке прямого обхода с
+// глубинами. Улучшенная вершина v отрезает свое поддерево: его вершины
+// держат устаревшие расстояния и не сканируются, пока их не улучшат
+// снова. Если в поддереве v оказывается u, улучшившая v, ребро u -> v
+// замыкает отрицательный цикл, и он находится в момент появления.
+class BellmanFordGoldbergRadzik : public SsspEngine {
+    CSRGraph graph;
+    std::vector<int> dist;
+    std::vector<int> parent;
+    bool track_parents;
+    // Дерево: круговой список в прямом порядке через источник
+    std::vector<int> next;
+    std::vector<int> prev;
+    std::vector<int> depth;
+    std::vector<char> in_tree;
+    // Вершины для следующего прохода; флаг снимается при сканировании
+    std::vector<int> labeled;
+    std::vector<char> is_labeled;
+    // Обход в глубину: 0 — не посещена, 1 — в стеке, 2 — завершена
+    std::vector<char> visit;
+    std::vector<std::pair<int, size_t>> stack;
+    std::vector<int> order;
+
+    // Вершины от ancestor вниз по дереву до descendant
+    std::vector<int> tree_path(int ancestor, int descendant) const {
+        std::vector<int> path;
+        for (int x = descendant; x != ancestor; x = parent[x]) {
+            path.push_back(x);
+        }
+        path.push_back(ancestor);
+        std::reverse(path.begin(), path.end());
+        return path;
+    }
+
+    void relax(int u, int v, int candidate SSSP_COUNT(, ThreadWork& counted)) {
+        if (candidate >= dist[v]) {
+            return;
+        }
+        SSSP_COUNT(++counted.relax_success; counted.reinsertions += dist[v] < INF);
+        if (u == v) {
+            throw NegativeCycleError({u});
+        }
+        if (in_tree[v]) {
+            // Разборка поддерева v: оно лежит в списке сразу за v
+            int x = next[v];
+            while (depth[x] > depth[v]) {
+                if (x == u) {
+                    throw NegativeCycleError(tree_path(v, u));
+                }
+                in_tree[x] = 0;
+                SSSP_COUNT(++counted.subtree_cuts);
+                x = next[x];
+            }
+            next[prev[v]] = x;
+            prev[x] = prev[v];
+        }
+        dist[v] = candidate;
+        parent[v] = u;
+        depth[v] = depth[u] + 1;
+        next[v] = next[u];
+        prev[v] = u;
+        prev[next[u]] = v;
+        next[u] = v;
+        in_tree[v] = 1;
+        if (!is_labeled[v]) {
+            is_labeled[v] = 1;
+            labeled.push_back(v);
+        }
+    }
+
+    // Топологический порядок вершин, достижимых из прошлого прохода по
+    // ребрам с отрицательной приведенной стоимостью, в order (обратный)
+    void sort_admissible(const size_t* offsets, const int* targets, const int* weights) {
+        order.clear();
+        for (int s : labeled) {
+            // Вершина вне дерева попадет в список снова, когда ее улучшат
+            if (!is_labeled[s]) {
+                continue;
+            }
+            is_labeled[s] = 0;
+            if (!in_tree[s] || visit[s] != 0) {
+                continue;
+            }
+            visit[s] = 1;
+            stack.push_back({s, offsets[s]});
+            while (!stack.empty()) {
+                auto& [x, e] = stack.back();
+                bool descended = false;
+                for (; e < offsets[x + 1]; ++e) {
+                    int y = targets[e];
+                    if (dist[x] + weights[e] >= dist[y] || visit[y] == 2) {
+                        continue;
+                    }
+                    if (visit[y] == 1) {
+                        // Обратное ребро: путь в стеке от y до x и ребро x -> y
+                        auto first = std::find_if(stack.begin(), stack.end(), [y](const auto& item) { return item.first == y; });
+                        std::vector<int> cycle;
+                        for (auto it = first; it != stack.end(); ++it) {
+                            cycle.push_back(it->first);
+                        }
+                        throw NegativeCycleError(cycle);
+                    }
+                    visit[y] = 1;
+                    ++e;
+                    stack.push_back({y, offsets[y]});
+                    descended = true;
+                    break;
+                }
+                if (!descended) {
+                    visit[x] = 2;
+                    order.push_back(x);
+                    stack.pop_back();
+                }
+            }
+        }
+    }
+
+    void reset_pass_state() {
+        for (int v : order) {
+            visit[v] = 0;
+        }
+        for (auto& [v, e] : stack) {
+            visit[v] = 0;
+        }
+        stack.clear();
+    }
+
+public:
+    BellmanFordGoldbergRadzik(const CSRGraph& graph, const EngineOptions& options)
+        : graph(graph), dist(graph.get_vertices()), parent(graph.get_vertices()), track_parents(options.parents),
+          next(graph.get_vertices()), prev(graph.get_vertices()), depth(graph.get_vertices()),
+          in_tree(graph.get_vertices()), is_labeled(graph.get_vertices()), visit(graph.get_vertices(), 0) {}
+
+    // Раунд — проход Голдберга-Радзика, фронт — вершины его порядка
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>* parents() override {
+        return track_parents ? &parent : nullptr;
+    }
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+
+        std::fill(dist.begin(), dist.end(), INF);
+        std::fill(parent.begin(), parent.end(), -1);
+        std::fill(in_tree.begin(), in_tree.end(), 0);
+        std::fill(is_labeled.begin(), is_labeled.end(), 0);
+        dist[source] = 0;
+        next[source] = prev[source] = source;
+        depth[source] = 0;
+        in_tree[source] = 1;
+        is_labeled[source] = 1;
+        labeled.assign(1, source);
+        SSSP_COUNT(ThreadWork& counted = work.current());
+
+        try {
+            while (!labeled.empty()) {
+                sort_admissible(offsets, targets, weights);
+                SSSP_COUNT(work.phase(order.size()));
+                labeled.clear();
+                for (auto it = order.rbegin(); it != order.rend(); ++it) {
+                    int u = *it;
+                    if (!in_tree[u]) {
+                        continue;
+                    }
+                    is_labeled[u] = 0;
+                    SSSP_COUNT(counted.relax_attempts += offsets[u + 1] - offsets[u]);
+                    for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                        relax(u, targets[e], dist[u] + weights[e] SSSP_COUNT(, counted));
+                    }
+                }
+                reset_pass_state();
+            }
+        } catch (const NegativeCycleError&) {
+            reset_pass_state();
+            throw;
+        }
+
+        return dist;
+    }
+};
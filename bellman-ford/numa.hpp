@@ -0,0 +1,181 @@
+#pragma once
+
+#include <algorithm>
+#include <iostream>
+#include <vector>
+#include <omp.h>
+#include "../common/graph.hpp"
+#include "../common/engine.hpp"
+#include "../common/numa.hpp"
+
+// Pull-вариант Bellman-Ford с размещением по узлам NUMA. Вершины делятся
+// на непрерывные диапазоны с равным числом входящих ребер, по одному на
+// поток; потоки привязаны к процессорам своих узлов (numa::Topology) и
+// сами копируют смещения, входящие ребра и расстояния своего диапазона,
+// поэтому страницы попадают на их узел первой записью. В раунде ребра
+// читаются локально, удаленными остаются только чтения расстояний соседей
+// из чужих диапазонов. Раунды по Якоби, как у BellmanFordPullOpenMP.
+// Раскладка строится под число потоков на момент подготовки, при смене
+// числа потоков она повторяется в первом запросе.
+class BellmanFordNumaOpenMP : public SsspEngine {
+    CSRGraph graph;
+    CSRGraph incoming;
+    numa::Topology topology;
+    int threads = 0;
+    std::vector<int> bounds; // диапазон потока t — [bounds[t], bounds[t + 1])
+    numa::Buffer<size_t> in_offsets;
+    numa::Buffer<int> sources;
+    numa::Buffer<int> in_weights;
+    numa::Buffer<int> dist;
+    numa::Buffer<int> next_dist;
+    std::vector<int> result;
+
+    // Разбиение по весу вершины «входящие ребра + 1» и размещение
+    // массивов первой записью потоков-владельцев
+    void place(int thread_count) {
+        threads = thread_count;
+        int vertices = graph.get_vertices();
+        size_t edges = incoming.get_edges_count();
+        const size_t* offsets = incoming.offsets();
+        const int* targets = incoming.targets();
+        const int* weights = incoming.weights();
+
+        bounds.assign(threads + 1, vertices);
+        bounds[0] = 0;
+        for (int t = 1; t < threads; ++t) {
+            size_t target = (edges + vertices) * t / threads;
+            int low = bounds[t - 1];
+            int high = vertices;
+            while (low < high) {
+                int middle = low + (high - low) / 2;
+                if (offsets[middle] + middle < target) {
+                    low = middle + 1;
+                } else {
+                    high = middle;
+                }
+            }
+            bounds[t] = low;
+        }
+
+        in_offsets = numa::Buffer<size_t>(vertices + 1);
+        sources = numa::Buffer<int>(edges);
+        in_weights = numa::Buffer<int>(edges);
+        dist = numa::Buffer<int>(vertices);
+        next_dist = numa::Buffer<int>(vertices);
+
+        #pragma omp parallel num_threads(threads)
+        {
+            int t = omp_get_thread_num();
+            numa::ThreadPin pin(topology.cpu_of_thread(t, threads));
+            int begin = bounds[t];
+            int end = bounds[t + 1];
+            for (int v = begin; v < end; ++v) {
+                in_offsets.data()[v] = offsets[v];
+                dist.data()[v] = INF;
+                next_dist.data()[v] = INF;
+            }
+            std::copy(targets + offsets[begin], targets + offsets[end], sources.data() + offsets[begin]);
+            std::copy(weights + offsets[begin], weights + offsets[end], in_weights.data() + offsets[begin]);
+            if (t == threads - 1) {
+                in_offsets.data()[vertices] = offsets[vertices];
+            }
+        }
+        report();
+    }
+
+    // Доля локальных чтений за раунд по фактическому размещению страниц
+    void report() const {
+        size_t page = numa::page_size();
+        int vertices = graph.get_vertices();
+        size_t edges = incoming.get_edges_count();
+        std::vector<int> edge_nodes = numa::page_nodes(sources.data(), edges * sizeof(int));
+        std::vector<int> dist_nodes = numa::page_nodes(dist.data(), vertices * sizeof(int));
+        const size_t* offsets = in_offsets.data();
+        const int* from = sources.data();
+
+        numa::Locality edge_reads;
+        numa::Locality neighbour_reads;
+        for (int t = 0; t < threads; ++t) {
+            int node = topology.node_id(topology.node_of_thread(t, threads));
+            for (size_t e = offsets[bounds[t]]; e < offsets[bounds[t + 1]]; ++e) {
+                edge_reads.add(edge_nodes[e * sizeof(int) / page], node);
+                neighbour_reads.add(dist_nodes[from[e] * sizeof(int) / page], node);
+            }
+        }
+
+        std::cout << "NUMA: узлов " << topology.nodes() << ", потоков " << threads
+                  << "; чтения ребер за раунд: локальных " << edge_reads.local << ", удаленных " << edge_reads.remote
+                  << "; чтения расстояний соседей: локальных " << neighbour_reads.local << ", удаленных " << neighbour_reads.remote;
+        if (edge_reads.unknown + neighbour_reads.unknown > 0) {
+            std::cout << ", узел неизвестен " << edge_reads.unknown + neighbour_reads.unknown;
+        }
+        std::cout << std::endl;
+    }
+
+public:
+    BellmanFordNumaOpenMP(const CSRGraph& graph, const EngineOptions&)
+        : graph(graph), incoming(graph.transpose()), topology(numa::Topology::detect()), result(graph.get_vertices()) {
+        place(omp_get_max_threads());
+    }
+
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        if (omp_get_max_threads() != threads) {
+            place(omp_get_max_threads());
+        }
+        int vertices = graph.get_vertices();
+        const size_t* offsets = in_offsets.data();
+        const int* from = sources.data();
+        const int* weights = in_weights.data();
+        // Номер последнего раунда с изменениями: записи раунда r делаются
+        // до его барьера, а r + 1 пишет только поток, увидевший изменения
+        // в раунде r, поэтому значение >= r означает, что раунд r что-то изменил
+        int last_changed = -1;
+
+        #pragma omp parallel num_threads(threads)
+        {
+            int t = omp_get_thread_num();
+            numa::ThreadPin pin(topology.cpu_of_thread(t, threads));
+            int begin = bounds[t];
+            int end = bounds[t + 1];
+            int* current = dist.data();
+            int* next = next_dist.data();
+            for (int v = begin; v < end; ++v) {
+                current[v] = v == source ? 0 : INF;
+            }
+            #pragma omp barrier
+
+            for (int round = 0; round < vertices - 1; ++round) {
+                bool changed = false;
+                for (int v = begin; v < end; ++v) {
+                    int best = current[v];
+                    for (size_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+                        int dist_u = current[from[e]];
+                        if (dist_u < INF && dist_u + weights[e] < best) {
+                            best = dist_u + weights[e];
+                        }
+                    }
+                    next[v] = best;
+                    changed = changed || best != current[v];
+                }
+                SSSP_COUNT(ThreadWork& counted = work.current();
+                           counted.relax_attempts += offsets[end] - offsets[begin];
+                           if (t == 0) { work.phase(vertices); })
+                if (changed) {
+                    __atomic_store_n(&last_changed, round, __ATOMIC_RELAXED);
+                }
+                #pragma omp barrier
+                std::swap(current, next);
+                if (__atomic_load_n(&last_changed, __ATOMIC_RELAXED) < round) {
+                    break;
+                }
+            }
+
+            std::copy(current + begin, current + end, result.begin() + begin);
+        }
+
+        return result;
+    }
+};
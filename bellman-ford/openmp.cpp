@@ -1,23 +1,39 @@
 #include <vector>
 #include <omp.h>
 #include "../common/graph.hpp"
+#include "../common/dijkstra.hpp"
 #include "task.hpp"
 #include "cpp.hpp"
 #include "openmp.hpp"
+#include "batch.hpp"
+#include "simd.hpp"
+#include "numa.hpp"
 
 int main(int argc, char* argv[]) {
     Impl impl;
     #ifdef OPENMP_CPU
-    impl = Impl{bellman_ford_openmp, "OpenMP CPU"};
+    impl = Impl{prepare<BellmanFordOpenMP>, "OpenMP CPU", "openmp"};
     #else
-    impl = Impl{bellman_ford_openmp, "OpenMP GPU"};
+    impl = Impl{prepare<BellmanFordOpenMP>, "OpenMP GPU", "openmp"};
     #endif
 
-    Task task({impl});
-    // Task task({Impl{bellman_ford_cpp, "C++"}, impl});
-    task.init(argc, argv);
-    for (int i = 0; i < 10; i++) {  
-        task.run();
+    std::vector<Impl> impls = {impl};
+    #ifdef OPENMP_CPU
+    impls.push_back(Impl{prepare_labeled<BasicBellmanFordFrontierOpenMP>, "OpenMP Frontier", "frontier"});
+    impls.push_back(Impl{prepare<BellmanFordPullOpenMP>, "OpenMP Pull", "pull"});
+    impls.push_back(Impl{prepare_batch, "OpenMP Batch", "batch"});
+    impls.push_back(Impl{prepare<BellmanFordSimd>, "OpenMP SIMD", "simd"});
+    impls.push_back(Impl{prepare<BellmanFordNumaOpenMP>, "OpenMP NUMA", "numa"});
+    impls.push_back(Impl{prepare<BellmanFordNegativeCycleOpenMP>, "OpenMP Negative", "negative"});
+    impls.push_back(Impl{prepare<BellmanFordSymmetricOpenMP>, "OpenMP Symmetric", "symmetric"});
+    #endif
+    impls.push_back(Impl{prepare<BellmanFordCpp>, "C++", "cpp"});
+    impls.push_back(Impl{prepare_dijkstra, "Dijkstra", "dijkstra"});
+
+    Task task(impls);
+    int status = task.init(argc, argv);
+    if (status != 0) {
+        return status == Task::DONE ? 0 : status;
     }
-    return 0;
+    return task.benchmark();
 }
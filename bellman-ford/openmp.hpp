@@ -1,54 +1,475 @@
+#include <algorithm>
+#include <type_traits>
 #include <vector>
 #include <omp.h>
-#include <chrono>
 #include "../common/graph.hpp"
+#include "../common/engine.hpp"
+#include "../common/atomics.hpp"
+#include "../common/paths.hpp"
+#include "../common/negative_cycle.hpp"
+#include "negative_cycle.hpp"
+#include "cpp.hpp"
 
-std::vector<int> bellman_ford_openmp(int vertices, std::vector<Edge> edges, int source, std::chrono::duration<double>& duration) {
-    std::vector<int> dist(vertices, INF);
-    dist[source] = 0;
+// Массивы графа переносятся на устройство один раз при подготовке,
+// между запросами передаются только расстояния
+class BellmanFordOpenMP : public SsspEngine {
+    CSRGraph graph;
+    std::vector<int> dist;
 
-    Edge* edges_ptr = edges.data();
-    int* edges_size_ptr = new int(edges.size());
-    int* dist_ptr = dist.data();
-    int* changed_ptr = new int(false);
+public:
+    BellmanFordOpenMP(const CSRGraph& graph, const EngineOptions&) : graph(graph), dist(graph.get_vertices()) {
+        #ifdef OPENMP_GPU
+        int vertices = graph.get_vertices();
+        size_t edges_size = graph.get_edges_count();
+        const size_t* offsets_ptr = graph.offsets();
+        const int* targets_ptr = graph.targets();
+        const int* weights_ptr = graph.weights();
+        int* dist_ptr = dist.data();
+        #pragma omp target enter data map(to: offsets_ptr[:vertices + 1], targets_ptr[:edges_size], weights_ptr[:edges_size]) map(alloc: dist_ptr[:vertices])
+        #endif
+    }
+
+    ~BellmanFordOpenMP() override {
+        #ifdef OPENMP_GPU
+        int vertices = graph.get_vertices();
+        size_t edges_size = graph.get_edges_count();
+        const size_t* offsets_ptr = graph.offsets();
+        const int* targets_ptr = graph.targets();
+        const int* weights_ptr = graph.weights();
+        int* dist_ptr = dist.data();
+        #pragma omp target exit data map(delete: offsets_ptr[:vertices + 1], targets_ptr[:edges_size], weights_ptr[:edges_size], dist_ptr[:vertices])
+        #endif
+    }
 
-    auto duration_ptr = &duration;
+    // На устройстве счетчики не ведутся, там отмечаются только раунды
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int vertices = graph.get_vertices();
+        const size_t* offsets_ptr = graph.offsets();
+        const int* targets_ptr = graph.targets();
+        const int* weights_ptr = graph.weights();
+        int* dist_ptr = dist.data();
+
+        std::fill(dist.begin(), dist.end(), INF);
+        dist[source] = 0;
+        #ifdef OPENMP_GPU
+        #pragma omp target update to(dist_ptr[:vertices])
+        #endif
 
-    #ifdef OPENMP_GPU
-    #pragma omp target data map(to:edges_ptr[:edges.size()], edges_size_ptr) map(tofrom: dist_ptr[:vertices], changed_ptr, duration_ptr)
-    #endif
-    {
-        auto start = std::chrono::high_resolution_clock::now();
         for (int i = 0; i < vertices - 1; ++i) {
-            *changed_ptr = false;
+            bool changed = false;
 
             #ifdef OPENMP_CPU
-            #pragma omp parallel for
+            #pragma omp parallel for schedule(dynamic, 64) reduction(||:changed)
             #else
-            #pragma omp target teams distribute parallel for
+            #pragma omp target teams distribute parallel for reduction(||:changed) map(tofrom: changed)
             #endif
-            for (size_t j = 0; j < *edges_size_ptr; ++j) {
-                int u = edges_ptr[j].from;
-                int v = edges_ptr[j].to;
-                int w = edges_ptr[j].weight;
+            for (int u = 0; u < vertices; ++u) {
+                int dist_u = dist_ptr[u];
+                if (dist_u >= INF) {
+                    continue;
+                }
+                #ifdef OPENMP_CPU
+                SSSP_COUNT(ThreadWork& counted = work.current(); counted.relax_attempts += offsets_ptr[u + 1] - offsets_ptr[u]);
+                #endif
 
-                if (dist_ptr[u] < INF && dist_ptr[u] + w < dist_ptr[v]) {
-                    *changed_ptr = true;
-                    #pragma omp atomic write
-                    dist_ptr[v] = dist_ptr[u] + w;
+                for (size_t e = offsets_ptr[u]; e < offsets_ptr[u + 1]; ++e) {
+                    int v = targets_ptr[e];
+                    int w = weights_ptr[e];
+
+                    if (dist_u + w < dist_ptr[v]) {
+                        #ifdef OPENMP_CPU
+                        SSSP_COUNT(++counted.relax_success; counted.reinsertions += dist_ptr[v] < INF);
+                        #endif
+                        changed = true;
+                        #pragma omp atomic write
+                        dist_ptr[v] = dist_u + w;
+                    }
                 }
             }
-            
-            if (!*changed_ptr) {
+            SSSP_COUNT(work.phase(vertices));
+
+            if (!changed) {
                 break;
             }
         }
-        auto stop = std::chrono::high_resolution_clock::now();
-        *duration_ptr = std::chrono::duration_cast<std::chrono::microseconds>(stop - start);
+
+        #ifdef OPENMP_GPU
+        #pragma omp target update from(dist_ptr[:vertices])
+        #endif
+        return dist;
+    }
+};
+
+// Параллельный вариант BellmanFordSymmetric: одна копия каждого
+// неориентированного ребра, за проход ребро {u, v} релаксируется в обе
+// стороны. Потоки пишут и в чужие строки, поэтому обе стороны
+// обновляются атомарным минимумом.
+class BellmanFordSymmetricOpenMP : public SsspEngine {
+    CSRGraph graph;
+    std::vector<int> dist;
+
+public:
+    BellmanFordSymmetricOpenMP(const CSRGraph& graph, const EngineOptions&)
+        : graph(symmetric_single_copy(graph)), dist(graph.get_vertices()) {}
+
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int vertices = graph.get_vertices();
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+        int* dist_ptr = dist.data();
+
+        std::fill(dist.begin(), dist.end(), INF);
+        dist[source] = 0;
+
+        for (int i = 0; i < vertices - 1; ++i) {
+            bool changed = false;
+
+            #pragma omp parallel for schedule(dynamic, 64) reduction(||:changed)
+            for (int u = 0; u < vertices; ++u) {
+                SSSP_COUNT(ThreadWork& counted = work.current(); counted.relax_attempts += 2 * (offsets[u + 1] - offsets[u]));
+                for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                    int v = targets[e];
+                    int w = weights[e];
+                    int dist_u = __atomic_load_n(&dist_ptr[u], __ATOMIC_RELAXED);
+                    int dist_v = __atomic_load_n(&dist_ptr[v], __ATOMIC_RELAXED);
+                    if (dist_u < INF && dist_u + w < dist_v && atomic_min(&dist_ptr[v], dist_u + w)) {
+                        SSSP_COUNT(++counted.relax_success; counted.reinsertions += dist_v < INF);
+                        changed = true;
+                    } else if (dist_v < INF && dist_v + w < dist_u && atomic_min(&dist_ptr[u], dist_v + w)) {
+                        SSSP_COUNT(++counted.relax_success; counted.reinsertions += dist_u < INF);
+                        changed = true;
+                    }
+                }
+            }
+            SSSP_COUNT(work.phase(vertices));
+
+            if (!changed) {
+                break;
+            }
+        }
+
+        return dist;
+    }
+};
+
+// Bellman-Ford по фронту с дедупликацией: в раунде релаксируются только
+// ребра вершин, улучшенных в прошлом раунде. Метки обновляются
+// атомарным минимумом, улучшенная вершина попадает в следующий фронт
+// один раз благодаря флагу in_next, а локальные буферы потоков
+// сливаются в общий фронт через атомарный сдвиг хвоста.
+// Label — int (только расстояния) или PackedLabel (расстояние с предком
+// в одном слове, см. prepare_labeled)
+template <typename Label>
+class BasicBellmanFordFrontierOpenMP : public SsspEngine {
+    CSRGraph graph;
+    std::vector<Label> labels;
+    std::vector<char> in_next;
+    std::vector<int> frontier;
+    std::vector<int> next_frontier;
+    std::vector<std::vector<int>> local_next;
+    std::vector<int> dist;
+    std::vector<int> parent;
+
+public:
+    BasicBellmanFordFrontierOpenMP(const CSRGraph& graph, const EngineOptions&)
+        : graph(graph), labels(graph.get_vertices()), in_next(graph.get_vertices(), 0),
+          frontier(graph.get_vertices()), next_frontier(graph.get_vertices()) {}
+
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>* parents() override {
+        return std::is_same_v<Label, int> ? nullptr : &parent;
+    }
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int vertices = graph.get_vertices();
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+        Label* labels_ptr = labels.data();
+        char* in_next_ptr = in_next.data();
+        if (local_next.size() < static_cast<size_t>(omp_get_max_threads())) {
+            local_next.resize(omp_get_max_threads());
+        }
+
+        size_t frontier_size = 1;
+        size_t next_size = 0;
+
+        std::fill(labels.begin(), labels.end(), make_label<Label>(INF, -1));
+        labels[source] = make_label<Label>(0, -1);
+        frontier[0] = source;
+
+        #pragma omp parallel
+        {
+            std::vector<int>& thread_next = local_next[omp_get_thread_num()];
+            SSSP_COUNT(ThreadWork& counted = work.current());
+
+            for (int i = 0; i < vertices - 1 && frontier_size > 0; ++i) {
+                SSSP_COUNT(if (omp_get_thread_num() == 0) { work.phase(frontier_size); })
+                #pragma omp for schedule(dynamic, 64) nowait
+                for (size_t j = 0; j < frontier_size; ++j) {
+                    int u = frontier[j];
+                    int dist_u = label_distance(__atomic_load_n(&labels_ptr[u], __ATOMIC_RELAXED));
+                    SSSP_COUNT(counted.relax_attempts += offsets[u + 1] - offsets[u]);
+                    for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                        int v = targets[e];
+                        SSSP_COUNT(bool reached = label_distance(__atomic_load_n(&labels_ptr[v], __ATOMIC_RELAXED)) < INF);
+                        if (!atomic_relax(&labels_ptr[v], make_label<Label>(dist_u + weights[e], u))) {
+                            continue;
+                        }
+                        SSSP_COUNT(++counted.relax_success; counted.reinsertions += reached);
+                        if (!__atomic_exchange_n(&in_next_ptr[v], 1, __ATOMIC_RELAXED)) {
+                            thread_next.push_back(v);
+                        }
+                    }
+                }
+
+                size_t position;
+                #pragma omp atomic capture
+                { position = next_size; next_size += thread_next.size(); }
+                std::copy(thread_next.begin(), thread_next.end(), next_frontier.begin() + position);
+                thread_next.clear();
+                #pragma omp barrier
+
+                #pragma omp for
+                for (size_t j = 0; j < next_size; ++j) {
+                    in_next_ptr[next_frontier[j]] = 0;
+                }
+
+                #pragma omp single
+                {
+                    frontier.swap(next_frontier);
+                    frontier_size = next_size;
+                    next_size = 0;
+                }
+            }
+        }
+
+        if constexpr (std::is_same_v<Label, int>) {
+            return labels;
+        } else {
+            unpack_labels(labels.data(), vertices, dist, parent);
+            return dist;
+        }
+    }
+};
+
+using BellmanFordFrontierOpenMP = BasicBellmanFordFrontierOpenMP<int>;
+
+// Поиск отрицательных циклов, параллельный вариант
+// BellmanFordGoldbergRadzik: Bellman-Ford по фронту с упакованными метками
+// (расстояние и предок в одном слове, см. PackedLabel), поэтому граф
+// предков всегда согласован с расстояниями, а цикл в нем отрицательный.
+// Разборка поддеревьев заменена проверкой предка: вершина фронта не
+// сканируется, если ее предок улучшен в более позднем раунде, чем она
+// сама, — ее расстояние устарело, и предок улучшит ее снова.
+// Граф предков проверяется на циклы из недавно улучшенных вершин, когда
+// их набирается V (амортизированно O(1) на улучшение), и в каждом
+// раунде после V - 1. Если за V - 1 раундов фронт не опустел, а цикл в
+// графе предков не найден, свидетель ищет последовательный вариант.
+class BellmanFordNegativeCycleOpenMP : public SsspEngine {
+    CSRGraph graph;
+    EngineOptions options;
+    std::vector<PackedLabel> labels;
+    std::vector<int> improved_round; // раунд последнего улучшения вершины
+    std::vector<char> in_next;
+    std::vector<int> frontier;
+    std::vector<int> next_frontier;
+    std::vector<std::vector<int>> local_next;
+    std::vector<int> recent; // улучшенные с последней проверки
+    ParentCycleFinder finder;
+    std::vector<int> dist;
+    std::vector<int> parent;
+
+    std::vector<int> find_cycle(const std::vector<int>& starts) {
+        const PackedLabel* labels_ptr = labels.data();
+        return finder.find(starts, [labels_ptr](int v) { return label_parent(labels_ptr[v]); });
     }
 
-    delete edges_size_ptr;
-    delete changed_ptr; 
+public:
+    BellmanFordNegativeCycleOpenMP(const CSRGraph& graph, const EngineOptions& options)
+        : graph(graph), options(options), labels(graph.get_vertices()), improved_round(graph.get_vertices()),
+          in_next(graph.get_vertices(), 0), frontier(graph.get_vertices()), next_frontier(graph.get_vertices()),
+          finder(graph.get_vertices()) {}
+
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>* parents() override {
+        return options.parents ? &parent : nullptr;
+    }
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int vertices = graph.get_vertices();
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+        PackedLabel* labels_ptr = labels.data();
+        int* round_ptr = improved_round.data();
+        char* in_next_ptr = in_next.data();
+        if (local_next.size() < static_cast<size_t>(omp_get_max_threads())) {
+            local_next.resize(omp_get_max_threads());
+        }
+
+        size_t frontier_size = 1;
+        size_t next_size = 0;
+        std::vector<int> cycle;
+
+        std::fill(labels.begin(), labels.end(), pack_label(INF, -1));
+        std::fill(improved_round.begin(), improved_round.end(), -1);
+        labels[source] = pack_label(0, -1);
+        frontier[0] = source;
+        recent.clear();
+
+        #pragma omp parallel
+        {
+            std::vector<int>& thread_next = local_next[omp_get_thread_num()];
+            SSSP_COUNT(ThreadWork& counted = work.current());
+
+            for (int i = 0; i < vertices - 1 && frontier_size > 0; ++i) {
+                SSSP_COUNT(if (omp_get_thread_num() == 0) { work.phase(frontier_size); })
+                #pragma omp for schedule(dynamic, 64) nowait
+                for (size_t j = 0; j < frontier_size; ++j) {
+                    int u = frontier[j];
+                    PackedLabel label_u = __atomic_load_n(&labels_ptr[u], __ATOMIC_RELAXED);
+                    int p = label_parent(label_u);
+                    if (p >= 0 && __atomic_load_n(&round_ptr[p], __ATOMIC_RELAXED) > __atomic_load_n(&round_ptr[u], __ATOMIC_RELAXED)) {
+                        continue;
+                    }
+                    int dist_u = label_distance(label_u);
+                    SSSP_COUNT(counted.relax_attempts += offsets[u + 1] - offsets[u]);
+                    for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                        int v = targets[e];
+                        SSSP_COUNT(bool reached = label_distance(__atomic_load_n(&labels_ptr[v], __ATOMIC_RELAXED)) < INF);
+                        if (!atomic_relax(&labels_ptr[v], pack_label(dist_u + weights[e], u))) {
+                            continue;
+                        }
+                        __atomic_store_n(&round_ptr[v], i, __ATOMIC_RELAXED);
+                        SSSP_COUNT(++counted.relax_success; counted.reinsertions += reached);
+                        if (!__atomic_exchange_n(&in_next_ptr[v], 1, __ATOMIC_RELAXED)) {
+                            thread_next.push_back(v);
+                        }
+                    }
+                }
+
+                size_t position;
+                #pragma omp atomic capture
+                { position = next_size; next_size += thread_next.size(); }
+                std::copy(thread_next.begin(), thread_next.end(), next_frontier.begin() + position);
+                thread_next.clear();
+                #pragma omp barrier
+
+                #pragma omp for
+                for (size_t j = 0; j < next_size; ++j) {
+                    in_next_ptr[next_frontier[j]] = 0;
+                }
+
+                #pragma omp single
+                {
+                    frontier.swap(next_frontier);
+                    frontier_size = next_size;
+                    next_size = 0;
+                    recent.insert(recent.end(), frontier.begin(), frontier.begin() + frontier_size);
+                    if (recent.size() >= static_cast<size_t>(vertices) || i + 2 >= vertices - 1) {
+                        cycle = find_cycle(recent);
+                        recent.clear();
+                        if (!cycle.empty()) {
+                            frontier_size = 0;
+                        }
+                    }
+                }
+            }
+        }
 
-    return dist;
-}
\ No newline at end of file
+        if (cycle.empty() && frontier_size > 0) {
+            // V - 1 раундов не хватило: отрицательный цикл есть наверняка
+            std::vector<int> all(vertices);
+            for (int v = 0; v < vertices; ++v) {
+                all[v] = v;
+            }
+            cycle = find_cycle(all);
+            if (cycle.empty()) {
+                EngineOptions exact_options = options;
+                exact_options.parents = true;
+                BellmanFordGoldbergRadzik exact(graph, exact_options);
+                dist = exact.solve(source);
+                parent = *exact.parents();
+                return dist;
+            }
+        }
+        if (!cycle.empty()) {
+            throw NegativeCycleError(cycle);
+        }
+
+        unpack_labels(labels.data(), vertices, dist, parent);
+        return dist;
+    }
+};
+
+// Pull-вариант Bellman-Ford без атомарных операций: в каждом раунде
+// вершина v сама вычисляет минимум по входящим ребрам транспонированного
+// графа и пишет только в свою ячейку. Раунды разделены двойной
+// буферизацией (по Якоби), поэтому результат детерминирован, а признак
+// изменения собирается редукцией, а не общей переменной.
+class BellmanFordPullOpenMP : public SsspEngine {
+    CSRGraph graph;
+    CSRGraph incoming;
+    std::vector<int> dist;
+    std::vector<int> next_dist;
+
+public:
+    BellmanFordPullOpenMP(const CSRGraph& graph, const EngineOptions&)
+        : graph(graph), incoming(graph.transpose()), dist(graph.get_vertices()), next_dist(graph.get_vertices()) {}
+
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int vertices = graph.get_vertices();
+        const size_t* in_offsets = incoming.offsets();
+        const int* sources = incoming.targets();
+        const int* in_weights = incoming.weights();
+
+        std::fill(dist.begin(), dist.end(), INF);
+        dist[source] = 0;
+
+        for (int i = 0; i < vertices - 1; ++i) {
+            const int* current = dist.data();
+            int* next = next_dist.data();
+            bool changed = false;
+
+            #pragma omp parallel for schedule(dynamic, 256) reduction(||:changed)
+            for (int v = 0; v < vertices; ++v) {
+                int best = current[v];
+                for (size_t e = in_offsets[v]; e < in_offsets[v + 1]; ++e) {
+                    int dist_u = current[sources[e]];
+                    if (dist_u < INF && dist_u + in_weights[e] < best) {
+                        best = dist_u + in_weights[e];
+                    }
+                }
+                next[v] = best;
+                changed = changed || best != current[v];
+                SSSP_COUNT(ThreadWork& counted = work.current();
+                           counted.relax_attempts += in_offsets[v + 1] - in_offsets[v];
+                           counted.relax_success += best != current[v];
+                           counted.reinsertions += best != current[v] && current[v] < INF);
+            }
+            SSSP_COUNT(work.phase(vertices));
+
+            dist.swap(next_dist);
+            if (!changed) {
+                break;
+            }
+        }
+
+        return dist;
+    }
+};
@@ -0,0 +1,14 @@
+#pragma once
+
+// Атомарный минимум: true, если значение по адресу уменьшилось.
+// Встроенные функции __atomic работают и в GCC, и в Clang, в том числе
+// внутри параллельных областей OpenMP.
+inline bool atomic_min(int* address, int value) {
+    int old = __atomic_load_n(address, __ATOMIC_RELAXED);
+    while (value < old) {
+        if (__atomic_compare_exchange_n(address, &old, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "counters.hpp"
+
+// Встроенный замер производительности: прогрев, повторы, статистика
+// по выборке времен и машиночитаемый вывод в JSON или CSV.
+namespace benchmark {
+
+// Сводная статистика по выборке времен, секунды
+struct Stats {
+    double min = 0;
+    double median = 0;
+    double p95 = 0;
+    double mean = 0;
+    double stddev = 0;
+
+    static Stats compute(std::vector<double> samples) {
+        Stats stats;
+        if (samples.empty()) {
+            return stats;
+        }
+        std::sort(samples.begin(), samples.end());
+        size_t n = samples.size();
+        stats.min = samples.front();
+        stats.median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+        // Перцентиль методом ближайшего ранга
+        size_t rank = static_cast<size_t>(std::ceil(0.95 * n));
+        stats.p95 = samples[std::max<size_t>(rank, 1) - 1];
+        for (double sample : samples) {
+            stats.mean += sample;
+        }
+        stats.mean /= n;
+        for (double sample : samples) {
+            stats.stddev += (sample - stats.mean) * (sample - stats.mean);
+        }
+        stats.stddev = n > 1 ? std::sqrt(stats.stddev / (n - 1)) : 0;
+        return stats;
+    }
+};
+
+// Результат серии запусков одной реализации в одной конфигурации
+struct Record {
+    std::string impl_name;
+    std::string key;
+    std::string graph;
+    int vertices = 0;
+    size_t edges = 0;
+    int threads = 1;
+    int sources = 1;
+    int delta = 0;       // ширина ведра дельта-шага, 0 — реализация без дельты
+    double prepare = 0;  // время подготовки движка, секунды
+    std::string reorder = "none";
+    double reorder_time = 0;   // время перенумерации графа, секунды
+    long long llc_misses = -1; // медиана промахов LLC за запуск, -1 — счетчик недоступен
+    bool has_counters = false; // счетчики работы последнего запуска (-DSSSP_COUNTERS)
+    WorkCounters counters;
+    std::vector<double> samples;
+    Stats stats;
+};
+
+// Разбор списка целых через запятую, например "1,2,4,8"
+inline std::vector<int> parse_int_list(const std::string& text) {
+    std::vector<int> values;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        size_t parsed = 0;
+        int value = std::stoi(item, &parsed);
+        if (parsed != item.size() || value <= 0) {
+            throw std::invalid_argument("List values must be positive integers: " + text);
+        }
+        values.push_back(value);
+    }
+    if (values.empty()) {
+        throw std::invalid_argument("Empty list");
+    }
+    return values;
+}
+
+inline int current_threads() {
+    #ifdef _OPENMP
+    return omp_get_max_threads();
+    #else
+    return 1;
+    #endif
+}
+
+inline void set_threads(int threads) {
+    #ifdef _OPENMP
+    omp_set_num_threads(threads);
+    #else
+    (void)threads;
+    #endif
+}
+
+inline std::string json_escape(const std::string& text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+inline void write_counters_json(std::ostream& out, const WorkCounters& counters) {
+    ThreadWork total = counters.total();
+    out << "{\"phases\": " << counters.phases << ", \"relax_attempts\": " << total.relax_attempts
+        << ", \"relax_success\": " << total.relax_success << ", \"reinsertions\": " << total.reinsertions
+        << ", \"light_edges\": " << total.light_edges << ", \"heavy_edges\": " << total.heavy_edges
+        << ", \"subtree_cuts\": " << total.subtree_cuts
+        << ", \"frontier_sizes\": [";
+    for (size_t i = 0; i < counters.frontier_sizes.size(); ++i) {
+        out << (i ? ", " : "") << counters.frontier_sizes[i];
+    }
+    out << "], \"thread_relax_attempts\": [";
+    for (size_t i = 0; i < counters.threads.size(); ++i) {
+        out << (i ? ", " : "") << counters.threads[i].relax_attempts;
+    }
+    out << "]}";
+}
+
+inline void write_json(std::ostream& out, const std::vector<Record>& records) {
+    out << std::setprecision(9) << "[\n";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const Record& r = records[i];
+        out << "  {\"impl\": \"" << json_escape(r.impl_name) << "\", \"key\": \"" << json_escape(r.key)
+            << "\", \"graph\": \"" << json_escape(r.graph) << "\", \"vertices\": " << r.vertices
+            << ", \"edges\": " << r.edges << ", \"threads\": " << r.threads << ", \"sources\": " << r.sources
+            << ", \"delta\": " << r.delta << ", \"prepare\": " << r.prepare
+            << ", \"reorder\": \"" << json_escape(r.reorder) << "\", \"reorder_time\": " << r.reorder_time
+            << ", \"llc_misses\": " << r.llc_misses
+            << ", \"min\": " << r.stats.min << ", \"median\": " << r.stats.median
+            << ", \"p95\": " << r.stats.p95 << ", \"mean\": " << r.stats.mean
+            << ", \"stddev\": " << r.stats.stddev << ", \"samples\": [";
+        for (size_t j = 0; j < r.samples.size(); ++j) {
+            out << (j ? ", " : "") << r.samples[j];
+        }
+        out << "]";
+        if (r.has_counters) {
+            out << ", \"counters\": ";
+            write_counters_json(out, r.counters);
+        }
+        out << "}" << (i + 1 < records.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+inline void write_csv(std::ostream& out, const std::vector<Record>& records) {
+    out << std::setprecision(9) << "impl,key,graph,vertices,edges,threads,sources,delta,prepare,reorder,reorder_time,llc_misses,repeat,min,median,p95,mean,stddev,"
+        << "phases,relax_attempts,relax_success,reinsertions,light_edges,heavy_edges,frontier_max,subtree_cuts\n";
+    for (const Record& r : records) {
+        // Без счетчиков столбцы работы равны -1, как llc_misses без perf
+        ThreadWork total = r.counters.total();
+        long long work[] = {r.counters.phases, total.relax_attempts, total.relax_success, total.reinsertions,
+                            total.light_edges, total.heavy_edges, r.counters.frontier_max(), total.subtree_cuts};
+        out << '"' << r.impl_name << "\"," << r.key << ",\"" << r.graph << "\"," << r.vertices << ','
+            << r.edges << ',' << r.threads << ',' << r.sources << ',' << r.delta << ',' << r.prepare << ',' << r.reorder << ','
+            << r.reorder_time << ',' << r.llc_misses << ',' << r.samples.size() << ',' << r.stats.min << ','
+            << r.stats.median << ',' << r.stats.p95 << ',' << r.stats.mean << ',' << r.stats.stddev;
+        for (long long value : work) {
+            out << ',' << (r.has_counters ? value : -1);
+        }
+        out << "\n";
+    }
+}
+
+// Параметры замера, общие для всех задач
+struct Options {
+    int warmup = 1;
+    int repeat = 10;
+    std::vector<int> threads;  // пусто — текущее число потоков
+    std::vector<int> sizes;    // пусто — граф из файла или --vertices
+    std::string output;        // файл результатов, формат по расширению (.json или .csv)
+
+    // Разбор одной опции, соглашения как у GeneratorOptions::parse_arg
+    int parse_arg(int& i, int argc, char* argv[]) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return 0;
+        }
+        try {
+            if (arg == "--warmup") {
+                warmup = std::stoi(argv[++i]);
+                if (warmup < 0) {
+                    std::cerr << "Ошибка: число прогревочных запусков не может быть отрицательным" << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--repeat") {
+                repeat = std::stoi(argv[++i]);
+                if (repeat <= 0) {
+                    std::cerr << "Ошибка: число повторов должно быть положительным" << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--threads" || arg == "--sizes") {
+                try {
+                    (arg == "--threads" ? threads : sizes) = parse_int_list(argv[++i]);
+                } catch (const std::exception&) {
+                    std::cerr << "Ошибка: элементы списка " << arg << " должны быть положительными целыми числами через запятую" << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--output") {
+                output = argv[++i];
+                if (!ends_with(output, ".json") && !ends_with(output, ".csv")) {
+                    std::cerr << "Ошибка: файл результатов должен иметь расширение .json или .csv" << std::endl;
+                    return -1;
+                }
+            } else {
+                return 0;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Ошибка: некорректное значение опции " << arg << ": " << argv[i] << std::endl;
+            return -1;
+        }
+        return 1;
+    }
+
+    std::vector<int> thread_counts() const {
+        return threads.empty() ? std::vector<int>{current_threads()} : threads;
+    }
+
+    void save(const std::vector<Record>& records) const {
+        if (output.empty()) {
+            return;
+        }
+        std::ofstream file(output);
+        if (!file.is_open()) {
+            throw std::runtime_error("Cannot open file for writing: " + output);
+        }
+        if (ends_with(output, ".csv")) {
+            write_csv(file, records);
+        } else {
+            write_json(file, records);
+        }
+    }
+
+    static void print_usage() {
+        std::cout << "  --warmup N      Прогревочные запуски без учета (по умолчанию 1)" << std::endl;
+        std::cout << "  --repeat N      Замеряемые запуски (по умолчанию 10)" << std::endl;
+        std::cout << "  --threads T,..  Перебор числа потоков OpenMP" << std::endl;
+        std::cout << "  --sizes N,..    Перебор количества вершин случайного графа" << std::endl;
+        std::cout << "  --output FILE   Сохранить результаты в FILE (.json или .csv)" << std::endl;
+    }
+
+private:
+    static bool ends_with(const std::string& text, const std::string& suffix) {
+        return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+};
+
+// Итоговая строка серии
+inline void print_record(const Record& r) {
+    std::cout << std::setw(18) << std::left << r.impl_name << "потоков: " << r.threads
+              << std::fixed << std::setprecision(6)
+              << ", min " << r.stats.min << ", медиана " << r.stats.median
+              << ", p95 " << r.stats.p95 << ", ст. откл. " << r.stats.stddev << " секунд";
+    if (r.delta > 0) {
+        std::cout << ", дельта " << r.delta;
+    }
+    if (r.reorder != "none") {
+        std::cout << ", порядок " << r.reorder;
+    }
+    if (r.llc_misses >= 0) {
+        std::cout << ", промахов LLC " << r.llc_misses;
+    }
+    std::cout << std::endl;
+    if (r.has_counters) {
+        ThreadWork total = r.counters.total();
+        std::cout << std::setw(18) << "" << "фаз: " << r.counters.phases << ", релаксаций " << total.relax_attempts
+                  << " (успешных " << total.relax_success << ", повторных " << total.reinsertions << ")";
+        if (total.light_edges || total.heavy_edges) {
+            std::cout << ", легких ребер " << total.light_edges << ", тяжелых " << total.heavy_edges;
+        }
+        if (total.subtree_cuts) {
+            std::cout << ", отрезано поддеревьями " << total.subtree_cuts;
+        }
+        std::cout << ", фронт до " << r.counters.frontier_max() << ", по потокам:";
+        for (const ThreadWork& work : r.counters.threads) {
+            std::cout << " " << work.relax_attempts;
+        }
+        std::cout << std::endl;
+    }
+}
+
+} // namespace benchmark
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "mapped_file.hpp"
+
+// Бинарный формат графа. Файл целиком отображается в память (mmap),
+// массивы CSR используются прямо из отображения, без копирования.
+//
+// Раскладка файла (little-endian):
+//   Header (128 байт); флаг FLAG_UNDIRECTED — неориентированный граф
+//   (дуги в обоих направлениях, как в CSRGraph::is_undirected)
+//   offsets[vertices + 1] (uint64), выровнено на 64 байта
+//   targets[edges]        (int32),  выровнено на 64 байта
+//   weights[edges]        (int32),  выровнено на 64 байта
+namespace binary_graph {
+
+const char MAGIC[8] = {'S', 'S', 'S', 'P', 'C', 'S', 'R', '\0'};
+const uint32_t VERSION = 1;
+const uint32_t BYTE_ORDER_MARK = 0x01020304;
+const uint64_t ALIGNMENT = 64;
+const uint64_t CHECKSUM_BLOCK = 1 << 20;
+const uint64_t FLAG_UNDIRECTED = 1;
+
+struct Header {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    uint64_t vertices;
+    uint64_t edges;
+    uint64_t offsets_position;
+    uint64_t targets_position;
+    uint64_t weights_position;
+    uint64_t file_size;
+    uint64_t checksum;
+    uint64_t flags;               // в файлах без флагов здесь нули
+    uint64_t reserved[6];
+};
+
+static_assert(sizeof(Header) == 128, "Binary graph header must stay 128 bytes");
+
+inline uint64_t align_up(uint64_t value) {
+    return (value + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+}
+
+inline uint64_t mix(uint64_t hash, uint64_t word) {
+    hash ^= word + 0x9e3779b97f4a7c15ull + (hash << 6) + (hash >> 2);
+    hash *= 0xff51afd7ed558ccdull;
+    return hash ^ (hash >> 33);
+}
+
+// Контрольная сумма данных: блоки по 1 МБ хешируются параллельно,
+// затем хеши блоков объединяются по порядку
+inline uint64_t checksum(const unsigned char* data, uint64_t size) {
+    uint64_t blocks = (size + CHECKSUM_BLOCK - 1) / CHECKSUM_BLOCK;
+    std::vector<uint64_t> block_hashes(blocks);
+
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (uint64_t b = 0; b < blocks; ++b) {
+        uint64_t begin = b * CHECKSUM_BLOCK;
+        uint64_t end = std::min(size, begin + CHECKSUM_BLOCK);
+        uint64_t hash = b;
+        uint64_t i = begin;
+        for (; i + 8 <= end; i += 8) {
+            uint64_t word;
+            std::memcpy(&word, data + i, 8);
+            hash = mix(hash, word);
+        }
+        for (; i < end; ++i) {
+            hash = mix(hash, data[i]);
+        }
+        block_hashes[b] = hash;
+    }
+
+    uint64_t hash = size;
+    for (uint64_t block_hash : block_hashes) {
+        hash = mix(hash, block_hash);
+    }
+    return hash;
+}
+
+// Проверка, является ли файл бинарным графом
+inline bool is_binary_graph_file(const std::string& filename) {
+    std::ifstream file(filename, std::ios::binary);
+    char magic[sizeof(MAGIC)] = {};
+    file.read(magic, sizeof(magic));
+    return file && std::memcmp(magic, MAGIC, sizeof(MAGIC)) == 0;
+}
+
+// Запись графа в бинарный формат
+inline void save(const CSRGraph& graph, const std::string& filename) {
+    uint64_t vertices = static_cast<uint64_t>(graph.get_vertices());
+    uint64_t edges = graph.get_edges_count();
+
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.byte_order = BYTE_ORDER_MARK;
+    header.vertices = vertices;
+    header.edges = edges;
+    header.flags = graph.is_undirected() ? FLAG_UNDIRECTED : 0;
+    header.offsets_position = align_up(sizeof(Header));
+    header.targets_position = align_up(header.offsets_position + sizeof(uint64_t) * (vertices + 1));
+    header.weights_position = align_up(header.targets_position + sizeof(int32_t) * edges);
+    header.file_size = header.weights_position + sizeof(int32_t) * edges;
+
+    std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Cannot open file for writing");
+    }
+
+    // Секции пишутся напрямую из массивов графа, без промежуточного буфера
+    const char padding[ALIGNMENT] = {};
+    auto write_section = [&](uint64_t position, const void* data, uint64_t size) {
+        uint64_t current = static_cast<uint64_t>(file.tellp());
+        file.write(padding, static_cast<std::streamsize>(position - current));
+        file.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    };
+    static_assert(sizeof(size_t) == sizeof(uint64_t), "CSR offsets must be 64-bit");
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    write_section(header.offsets_position, graph.offsets(), sizeof(uint64_t) * (vertices + 1));
+    write_section(header.targets_position, graph.targets(), sizeof(int32_t) * edges);
+    write_section(header.weights_position, graph.weights(), sizeof(int32_t) * edges);
+    file.close();
+    if (!file) {
+        throw std::runtime_error("Cannot write binary graph");
+    }
+
+    // Контрольная сумма покрывает все после заголовка; она считается по уже
+    // записанному файлу, и заголовок перезаписывается на месте
+    {
+        MappedFile written(filename);
+        header.checksum = checksum(written.get_data() + sizeof(Header), written.get_size() - sizeof(Header));
+    }
+    std::fstream patch(filename, std::ios::binary | std::ios::in | std::ios::out);
+    patch.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!patch) {
+        throw std::runtime_error("Cannot write binary graph");
+    }
+}
+
+// Структура строк [first, last) отображенного файла: offsets не убывают
+// и не выходят за edges, концы ребер лежат в [0, vertices). Движки
+// доверяют этим массивам, поэтому без проверки испорченный файл
+// приводит к чтению за пределами dist
+inline bool valid_rows(const size_t* offsets, const int* targets, int vertices, size_t edges, int first, int last) {
+    if (offsets[last] > edges) {
+        return false;
+    }
+    bool invalid = false;
+    #pragma omp parallel for reduction(||:invalid)
+    for (int u = first; u < last; ++u) {
+        invalid = invalid || offsets[u] > offsets[u + 1];
+    }
+    if (invalid) {
+        return false;
+    }
+    #pragma omp parallel for reduction(||:invalid)
+    for (size_t e = offsets[first]; e < offsets[last]; ++e) {
+        invalid = invalid || targets[e] < 0 || targets[e] >= vertices;
+    }
+    return !invalid;
+}
+
+// Загрузка графа без копирования: массивы CSR указывают в отображенный файл,
+// который живет, пока жива хотя бы одна копия графа.
+// Структура (valid_rows) проверяется всегда, контрольная сумма — только
+// с verify: она читает весь файл, включая веса. Без prefetch файл не
+// подкачивается заранее и читается только там, где к нему обращаются
+// (свои строки процесса MPI); тогда и структура проверяется только по
+// своим строкам, в distributed::local_rows.
+inline CSRGraph load(const std::string& filename, bool verify = false, bool prefetch = true) {
+    auto file = std::make_shared<MappedFile>(filename);
+    const unsigned char* data = file->get_data();
+
+    if (file->get_size() < sizeof(Header)) {
+        throw std::runtime_error("Binary graph file is truncated");
+    }
+    Header header;
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("Not a binary graph file");
+    }
+    if (header.byte_order != BYTE_ORDER_MARK) {
+        throw std::runtime_error("Binary graph file has a different byte order");
+    }
+    if (header.version != VERSION) {
+        throw std::runtime_error("Unsupported binary graph version " + std::to_string(header.version));
+    }
+    if (header.vertices > static_cast<uint64_t>(std::numeric_limits<int>::max())) {
+        throw std::runtime_error("Too many vertices in binary graph");
+    }
+    // Размеры сравниваются делением, а не умножением: в испорченном
+    // заголовке edges может быть любым, и произведение переполнилось бы
+    auto section_fits = [](uint64_t position, uint64_t count, uint64_t element, uint64_t limit) {
+        return position <= limit && count <= (limit - position) / element;
+    };
+    if (header.file_size != file->get_size()
+        || header.offsets_position % ALIGNMENT != 0
+        || header.targets_position % ALIGNMENT != 0
+        || header.weights_position % ALIGNMENT != 0
+        || header.offsets_position < sizeof(Header)
+        || !section_fits(header.offsets_position, header.vertices + 1, sizeof(uint64_t), header.targets_position)
+        || !section_fits(header.targets_position, header.edges, sizeof(int32_t), header.weights_position)
+        || !section_fits(header.weights_position, header.edges, sizeof(int32_t), header.file_size)) {
+        throw std::runtime_error("Binary graph file is truncated or corrupted");
+    }
+
+    const size_t* offsets = reinterpret_cast<const size_t*>(data + header.offsets_position);
+    const int* targets = reinterpret_cast<const int*>(data + header.targets_position);
+    const int* weights = reinterpret_cast<const int*>(data + header.weights_position);
+    int vertices = static_cast<int>(header.vertices);
+
+    if (offsets[0] != 0 || offsets[vertices] != header.edges) {
+        throw std::runtime_error("Binary graph file is corrupted");
+    }
+
+    if (prefetch) {
+        file->advise(header.offsets_position, header.file_size - header.offsets_position, MADV_WILLNEED);
+    }
+    if ((prefetch || verify) && !valid_rows(offsets, targets, vertices, header.edges, 0, vertices)) {
+        throw std::runtime_error("Binary graph file is corrupted");
+    }
+    if (verify && checksum(data + sizeof(Header), header.file_size - sizeof(Header)) != header.checksum) {
+        throw std::runtime_error("Binary graph checksum mismatch");
+    }
+    CSRGraph graph(vertices, header.edges, offsets, targets, weights, std::move(file));
+    graph.mark_undirected((header.flags & FLAG_UNDIRECTED) != 0);
+    return graph;
+}
+
+}
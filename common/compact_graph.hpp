@@ -0,0 +1,207 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "engine.hpp"
+
+// "Бесконечное" расстояние для типа Distance; половина диапазона,
+// чтобы сумма INF и веса ребра не переполнялась
+template <typename Distance>
+constexpr Distance distance_inf() {
+    return std::numeric_limits<Distance>::max() / 2;
+}
+
+// Компактный CSR с настраиваемыми типами номера вершины, веса и смещения.
+// Интерфейс совпадает с CSRGraph (offsets, targets, weights, split_by_weight),
+// поэтому шаблонные движки принимают любой из них.
+template <typename Vertex, typename Weight, typename Offset>
+class CompactCSRGraph {
+public:
+    typedef Vertex vertex_type;
+    typedef Weight weight_type;
+    typedef Offset offset_type;
+
+private:
+    struct Storage {
+        std::vector<Offset> offsets;
+        std::vector<Vertex> targets;
+        std::vector<Weight> weights;
+    };
+
+    int vertices = 0;
+    size_t edges_count = 0;
+    std::shared_ptr<const Storage> storage;
+
+    CompactCSRGraph(int num_vertices, Storage data)
+        : vertices(num_vertices), edges_count(data.targets.size()),
+          storage(std::make_shared<Storage>(std::move(data))) {}
+
+public:
+    CompactCSRGraph() = default;
+
+    // Сужение типов; вызывающий заранее проверяет, что значения помещаются
+    explicit CompactCSRGraph(const CSRGraph& graph) : vertices(graph.get_vertices()), edges_count(graph.get_edges_count()) {
+        Storage data;
+        data.offsets.resize(static_cast<size_t>(vertices) + 1);
+        data.targets.resize(edges_count);
+        data.weights.resize(edges_count);
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+        Offset* offsets_out = data.offsets.data();
+        Vertex* targets_out = data.targets.data();
+        Weight* weights_out = data.weights.data();
+
+        #pragma omp parallel for
+        for (int u = 0; u <= vertices; ++u) {
+            offsets_out[u] = static_cast<Offset>(offsets[u]);
+        }
+        #pragma omp parallel for
+        for (size_t e = 0; e < edges_count; ++e) {
+            targets_out[e] = static_cast<Vertex>(targets[e]);
+            weights_out[e] = static_cast<Weight>(weights[e]);
+        }
+        storage = std::make_shared<Storage>(std::move(data));
+    }
+
+    // Разделение ребер на легкие (weight < delta) и тяжелые (weight >= delta)
+    template <typename Distance>
+    std::pair<CompactCSRGraph, CompactCSRGraph> split_by_weight(Distance delta) const {
+        Storage light, heavy;
+        light.offsets.assign(static_cast<size_t>(vertices) + 1, 0);
+        heavy.offsets.assign(static_cast<size_t>(vertices) + 1, 0);
+        const Offset* offsets = storage->offsets.data();
+        const Weight* weights = storage->weights.data();
+        for (int u = 0; u < vertices; ++u) {
+            Offset light_count = 0;
+            for (Offset e = offsets[u]; e < offsets[u + 1]; ++e) {
+                light_count += static_cast<Distance>(weights[e]) < delta;
+            }
+            light.offsets[u + 1] = light.offsets[u] + light_count;
+            heavy.offsets[u + 1] = heavy.offsets[u] + (offsets[u + 1] - offsets[u]) - light_count;
+        }
+        light.targets.reserve(light.offsets.back());
+        light.weights.reserve(light.offsets.back());
+        heavy.targets.reserve(heavy.offsets.back());
+        heavy.weights.reserve(heavy.offsets.back());
+        for (size_t e = 0; e < edges_count; ++e) {
+            Storage& part = static_cast<Distance>(weights[e]) < delta ? light : heavy;
+            part.targets.push_back(storage->targets[e]);
+            part.weights.push_back(weights[e]);
+        }
+        return {CompactCSRGraph(vertices, std::move(light)), CompactCSRGraph(vertices, std::move(heavy))};
+    }
+
+    int get_vertices() const {
+        return vertices;
+    }
+
+    size_t get_edges_count() const {
+        return edges_count;
+    }
+
+    const Offset* offsets() const {
+        return storage->offsets.data();
+    }
+
+    const Vertex* targets() const {
+        return storage->targets.data();
+    }
+
+    const Weight* weights() const {
+        return storage->weights.data();
+    }
+
+    // Объем массивов графа в байтах
+    size_t memory_size() const {
+        return (static_cast<size_t>(vertices) + 1) * sizeof(Offset) + edges_count * (sizeof(Vertex) + sizeof(Weight));
+    }
+};
+
+// Перевод расстояний шаблонного движка в общий формат int с INF.
+// Для int копирование не нужно, поэтому возвращается сам вектор.
+template <typename Distance>
+const std::vector<int>& export_distances(const std::vector<Distance>& distances, std::vector<int>& out) {
+    if constexpr (std::is_same_v<Distance, int>) {
+        return distances;
+    } else {
+        out.resize(distances.size());
+        for (size_t v = 0; v < distances.size(); ++v) {
+            if (distances[v] >= distance_inf<Distance>()) {
+                out[v] = INF;
+            } else if (distances[v] >= static_cast<Distance>(INF)) {
+                throw std::overflow_error("Distance " + std::to_string(distances[v]) + " of vertex " + std::to_string(v)
+                                          + " does not fit into int");
+            } else {
+                out[v] = static_cast<int>(distances[v]);
+            }
+        }
+        return out;
+    }
+}
+
+// Самые узкие безопасные типы для графа: веса uint8/uint16 при
+// неотрицательных весах, смещения uint32 при числе ребер < 2^32,
+// расстояния uint32, если самый длинный простой путь заведомо меньше INF
+struct CompactLayout {
+    enum Weights { Uint8, Uint16, Int32 } weights = Int32;
+    bool wide_offsets = true;
+    bool wide_distances = true;
+
+    static CompactLayout choose(const CSRGraph& graph) {
+        const int* weights = graph.weights();
+        size_t edges = graph.get_edges_count();
+        int min_weight = 0;
+        int max_weight = 0;
+        #pragma omp parallel for reduction(min:min_weight) reduction(max:max_weight)
+        for (size_t e = 0; e < edges; ++e) {
+            min_weight = std::min(min_weight, weights[e]);
+            max_weight = std::max(max_weight, weights[e]);
+        }
+
+        CompactLayout layout;
+        layout.wide_offsets = edges > std::numeric_limits<uint32_t>::max();
+        if (min_weight >= 0) {
+            uint64_t longest_path = static_cast<uint64_t>(std::max(graph.get_vertices() - 1, 0)) * max_weight;
+            layout.wide_distances = longest_path >= distance_inf<uint32_t>();
+            if (!layout.wide_distances && max_weight <= std::numeric_limits<uint8_t>::max()) {
+                layout.weights = Uint8;
+            } else if (!layout.wide_distances && max_weight <= std::numeric_limits<uint16_t>::max()) {
+                layout.weights = Uint16;
+            }
+        }
+        return layout;
+    }
+};
+
+// Подготовка шаблонного движка Engine<Graph, Distance> на самом узком
+// подходящем представлении графа. Отрицательные веса или длинные пути
+// переводят движок на int32-веса и int64-расстояния.
+template <template <typename, typename> class Engine, typename Offset>
+EngineHandle prepare_compact_with_offsets(const CSRGraph& graph, const EngineOptions& options, const CompactLayout& layout) {
+    switch (layout.weights) {
+        case CompactLayout::Uint8:
+            return std::make_unique<Engine<CompactCSRGraph<uint32_t, uint8_t, Offset>, uint32_t>>(graph, options);
+        case CompactLayout::Uint16:
+            return std::make_unique<Engine<CompactCSRGraph<uint32_t, uint16_t, Offset>, uint32_t>>(graph, options);
+        default:
+            return std::make_unique<Engine<CompactCSRGraph<uint32_t, int32_t, Offset>, int64_t>>(graph, options);
+    }
+}
+
+template <template <typename, typename> class Engine>
+EngineHandle prepare_compact(const CSRGraph& graph, const EngineOptions& options) {
+    CompactLayout layout = CompactLayout::choose(graph);
+    if (layout.wide_offsets) {
+        return prepare_compact_with_offsets<Engine, uint64_t>(graph, options, layout);
+    }
+    return prepare_compact_with_offsets<Engine, uint32_t>(graph, options, layout);
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Счетчики работы алгоритма: сколько ребер просмотрено и сколько из них
+// уменьшили расстояние, сколько было раундов (фаз) и какого размера фронт.
+// Отличают лишнюю работу (повторные релаксации, слишком мелкие фазы) от
+// плохой параллельной эффективности (перекос работы между потоками).
+// Включаются флагом компиляции -DSSSP_COUNTERS; без него SSSP_COUNT не
+// порождает кода, а движки не отдают счетчики (counters() == nullptr).
+#ifdef SSSP_COUNTERS
+#define SSSP_COUNT(...) __VA_ARGS__
+#else
+#define SSSP_COUNT(...)
+#endif
+
+// Работа одного потока. Выравнивание исключает ложное разделение
+// кэш-линий между счетчиками соседних потоков.
+struct alignas(64) ThreadWork {
+    long long relax_attempts = 0; // просмотренные ребра
+    long long relax_success = 0;  // ребра, уменьшившие расстояние
+    long long reinsertions = 0;   // уменьшения уже конечного расстояния
+    long long light_edges = 0;    // ребра легкой фазы дельта-шага
+    long long heavy_edges = 0;    // ребра тяжелой фазы дельта-шага
+    long long subtree_cuts = 0;   // вершины, отрезанные разборкой поддеревьев (Голдберг-Радзик)
+
+    void add(const ThreadWork& other) {
+        relax_attempts += other.relax_attempts;
+        relax_success += other.relax_success;
+        reinsertions += other.reinsertions;
+        light_edges += other.light_edges;
+        heavy_edges += other.heavy_edges;
+        subtree_cuts += other.subtree_cuts;
+    }
+};
+
+// Счетчики серии запросов: задача обнуляет их перед запуском движка и
+// читает после. Потоки пишут каждый в свою ячейку threads, фазы и фронт
+// отмечает один поток.
+class WorkCounters {
+public:
+    long long phases = 0; // раунды Bellman-Ford или фазы дельта-шага
+    std::vector<long long> frontier_sizes; // вершин в обработке по фазам
+    std::vector<ThreadWork> threads;
+
+    WorkCounters() {
+        reset();
+    }
+
+    void reset() {
+        phases = 0;
+        frontier_sizes.clear();
+        #ifdef _OPENMP
+        threads.assign(std::max(omp_get_max_threads(), 1), ThreadWork{});
+        #else
+        threads.assign(1, ThreadWork{});
+        #endif
+    }
+
+    // Ячейка вызывающего потока
+    ThreadWork& current() {
+        #ifdef _OPENMP
+        return threads[omp_get_thread_num()];
+        #else
+        return threads[0];
+        #endif
+    }
+
+    void phase(size_t frontier_size) {
+        ++phases;
+        frontier_sizes.push_back(static_cast<long long>(frontier_size));
+    }
+
+    ThreadWork total() const {
+        ThreadWork sum;
+        for (const ThreadWork& work : threads) {
+            sum.add(work);
+        }
+        return sum;
+    }
+
+    long long frontier_max() const {
+        return frontier_sizes.empty() ? 0 : *std::max_element(frontier_sizes.begin(), frontier_sizes.end());
+    }
+};
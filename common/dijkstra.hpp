@@ -0,0 +1,328 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "engine.hpp"
+
+// Очереди с приоритетом для алгоритма Дейкстры. Общий интерфейс:
+// push(v, key) вставляет вершину или уменьшает ее ключ, pop() возвращает
+// пару (ключ, вершина) с наименьшим ключом, clear() очищает очередь.
+
+// d-арная куча с индексом позиций: уменьшение ключа — подъем на месте.
+// Четверичная куча ниже и шире двоичной, дети одного узла лежат в одной
+// строке кэша
+template <int Arity>
+class DaryHeap {
+    std::vector<std::pair<int, int>> heap;
+    std::vector<int> position;
+
+    void place(size_t i, std::pair<int, int> item) {
+        heap[i] = item;
+        position[item.second] = static_cast<int>(i);
+    }
+
+    void sift_up(size_t i) {
+        std::pair<int, int> item = heap[i];
+        while (i > 0) {
+            size_t parent = (i - 1) / Arity;
+            if (heap[parent].first <= item.first) {
+                break;
+            }
+            place(i, heap[parent]);
+            i = parent;
+        }
+        place(i, item);
+    }
+
+    void sift_down(size_t i) {
+        std::pair<int, int> item = heap[i];
+        size_t size = heap.size();
+        while (true) {
+            size_t first = i * Arity + 1;
+            if (first >= size) {
+                break;
+            }
+            size_t best = first;
+            size_t last = std::min(first + Arity, size);
+            for (size_t child = first + 1; child < last; ++child) {
+                if (heap[child].first < heap[best].first) {
+                    best = child;
+                }
+            }
+            if (heap[best].first >= item.first) {
+                break;
+            }
+            place(i, heap[best]);
+            i = best;
+        }
+        place(i, item);
+    }
+
+public:
+    explicit DaryHeap(int vertices) : position(vertices, -1) {
+        heap.reserve(vertices);
+    }
+
+    bool empty() const {
+        return heap.empty();
+    }
+
+    void push(int vertex, int key) {
+        if (position[vertex] == -1) {
+            heap.emplace_back(key, vertex);
+            sift_up(heap.size() - 1);
+        } else if (key < heap[position[vertex]].first) {
+            heap[position[vertex]].first = key;
+            sift_up(position[vertex]);
+        }
+    }
+
+    std::pair<int, int> pop() {
+        std::pair<int, int> top = heap.front();
+        position[top.second] = -1;
+        std::pair<int, int> last = heap.back();
+        heap.pop_back();
+        if (!heap.empty()) {
+            heap.front() = last;
+            sift_down(0);
+        }
+        return top;
+    }
+
+    void clear() {
+        for (const auto& item : heap) {
+            position[item.second] = -1;
+        }
+        heap.clear();
+    }
+};
+
+// Парная куча на массивах: у вершины есть первый ребенок, правый брат
+// и ссылка prev (родитель для первого ребенка, иначе левый брат).
+// Уменьшение ключа — вырезание поддерева и слияние с корнем за O(1),
+// извлечение минимума — двухпроходное слияние детей корня
+class PairingHeap {
+    std::vector<int> key;
+    std::vector<int> child;
+    std::vector<int> sibling;
+    std::vector<int> prev;
+    std::vector<char> in_heap;
+    std::vector<int> roots;
+    int root = -1;
+
+    int meld(int a, int b) {
+        if (key[b] < key[a]) {
+            std::swap(a, b);
+        }
+        sibling[b] = child[a];
+        if (child[a] != -1) {
+            prev[child[a]] = b;
+        }
+        prev[b] = a;
+        child[a] = b;
+        return a;
+    }
+
+    void cut(int vertex) {
+        if (child[prev[vertex]] == vertex) {
+            child[prev[vertex]] = sibling[vertex];
+        } else {
+            sibling[prev[vertex]] = sibling[vertex];
+        }
+        if (sibling[vertex] != -1) {
+            prev[sibling[vertex]] = prev[vertex];
+        }
+        sibling[vertex] = -1;
+        prev[vertex] = -1;
+    }
+
+public:
+    explicit PairingHeap(int vertices)
+        : key(vertices), child(vertices, -1), sibling(vertices, -1), prev(vertices, -1), in_heap(vertices, 0) {}
+
+    bool empty() const {
+        return root == -1;
+    }
+
+    void push(int vertex, int new_key) {
+        if (!in_heap[vertex]) {
+            in_heap[vertex] = 1;
+            key[vertex] = new_key;
+            child[vertex] = sibling[vertex] = prev[vertex] = -1;
+            root = root == -1 ? vertex : meld(root, vertex);
+        } else if (new_key < key[vertex]) {
+            key[vertex] = new_key;
+            if (vertex != root) {
+                cut(vertex);
+                root = meld(root, vertex);
+            }
+        }
+    }
+
+    std::pair<int, int> pop() {
+        int top = root;
+        in_heap[top] = 0;
+        roots.clear();
+        for (int c = child[top]; c != -1;) {
+            int next = sibling[c];
+            sibling[c] = prev[c] = -1;
+            roots.push_back(c);
+            c = next;
+        }
+        // Первый проход — попарно слева направо, второй — справа налево
+        size_t pairs = 0;
+        for (size_t i = 0; i + 1 < roots.size(); i += 2) {
+            roots[pairs++] = meld(roots[i], roots[i + 1]);
+        }
+        if (roots.size() % 2) {
+            roots[pairs++] = roots.back();
+        }
+        root = -1;
+        for (size_t i = pairs; i-- > 0;) {
+            root = root == -1 ? roots[i] : meld(roots[i], root);
+        }
+        return {key[top], top};
+    }
+
+    void clear() {
+        while (!empty()) {
+            pop();
+        }
+    }
+};
+
+// Радиксная куча (Ахуджа, Мельхорн, Орлин, Тарьян) для монотонной
+// очереди с неотрицательными целыми ключами: элемент лежит в корзине по
+// старшему биту, которым ключ отличается от последнего извлеченного.
+// Ключи не сравниваются между собой, каждый элемент переносится не более
+// 32 раз. Уменьшение ключа — вставка новой копии, устаревшие копии
+// пропускает вызывающий (ключ больше текущего расстояния)
+class RadixHeap {
+    static constexpr int buckets_count = 33;
+    std::vector<std::pair<int, int>> buckets[buckets_count];
+    unsigned last = 0;
+    size_t size = 0;
+
+    int bucket_of(int key) const {
+        unsigned difference = static_cast<unsigned>(key) ^ last;
+        return difference == 0 ? 0 : 32 - __builtin_clz(difference);
+    }
+
+public:
+    explicit RadixHeap(int) {}
+
+    bool empty() const {
+        return size == 0;
+    }
+
+    void push(int vertex, int key) {
+        buckets[bucket_of(key)].emplace_back(key, vertex);
+        ++size;
+    }
+
+    std::pair<int, int> pop() {
+        if (buckets[0].empty()) {
+            int i = 1;
+            while (buckets[i].empty()) {
+                ++i;
+            }
+            // Новый минимум становится точкой отсчета, остальные элементы
+            // корзины опускаются в корзины с меньшими номерами
+            last = static_cast<unsigned>(std::min_element(buckets[i].begin(), buckets[i].end())->first);
+            for (const auto& item : buckets[i]) {
+                buckets[bucket_of(item.first)].push_back(item);
+            }
+            buckets[i].clear();
+        }
+        std::pair<int, int> top = buckets[0].back();
+        buckets[0].pop_back();
+        --size;
+        return top;
+    }
+
+    void clear() {
+        for (auto& bucket : buckets) {
+            bucket.clear();
+        }
+        last = 0;
+        size = 0;
+    }
+};
+
+// Последовательный алгоритм Дейкстры — эталон для ускорения параллельных
+// реализаций. Только для неотрицательных весов: граф проверяется при подготовке.
+// С EngineOptions::parents строит и дерево кратчайших путей
+template <typename Heap>
+class Dijkstra : public SsspEngine {
+    CSRGraph graph;
+    Heap heap;
+    std::vector<int> dist;
+    std::vector<int> parent; // пусто, если предки не нужны
+
+public:
+    Dijkstra(const CSRGraph& graph, const EngineOptions& options)
+        : graph(graph), heap(graph.get_vertices()), dist(graph.get_vertices()),
+          parent(options.parents ? graph.get_vertices() : 0) {
+        const int* weights = graph.weights();
+        if (std::any_of(weights, weights + graph.get_edges_count(), [](int w) { return w < 0; })) {
+            throw UnsupportedGraph("Dijkstra requires non-negative edge weights");
+        }
+    }
+
+    const std::vector<int>* parents() override {
+        return parent.empty() ? nullptr : &parent;
+    }
+
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+        bool track_parents = !parent.empty();
+
+        std::fill(dist.begin(), dist.end(), INF);
+        std::fill(parent.begin(), parent.end(), -1);
+        heap.clear();
+        dist[source] = 0;
+        heap.push(source, 0);
+
+        while (!heap.empty()) {
+            auto [dist_u, u] = heap.pop();
+            if (dist_u > dist[u]) {
+                continue;
+            }
+            for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                int v = targets[e];
+                int candidate = dist_u + weights[e];
+                if (candidate < dist[v]) {
+                    dist[v] = candidate;
+                    if (track_parents) {
+                        parent[v] = u;
+                    }
+                    heap.push(v, candidate);
+                }
+            }
+        }
+
+        return dist;
+    }
+};
+
+// Выбор очереди по EngineOptions::heap
+inline EngineHandle prepare_dijkstra(const CSRGraph& graph, const EngineOptions& options) {
+    if (options.heap == "binary") {
+        return std::make_unique<Dijkstra<DaryHeap<2>>>(graph, options);
+    } else if (options.heap == "4ary") {
+        return std::make_unique<Dijkstra<DaryHeap<4>>>(graph, options);
+    } else if (options.heap == "pairing") {
+        return std::make_unique<Dijkstra<PairingHeap>>(graph, options);
+    } else if (options.heap == "radix") {
+        return std::make_unique<Dijkstra<RadixHeap>>(graph, options);
+    }
+    throw std::invalid_argument("Unknown heap: " + options.heap);
+}
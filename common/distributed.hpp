@@ -0,0 +1,274 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <mpi.h>
+#include "graph.hpp"
+#include "engine.hpp"
+#include "binary_graph.hpp"
+
+// Общие части распределенных (MPI) реализаций: одномерное блочное
+// разбиение вершин по процессам, строки графа своих вершин, обмен
+// запросами на релаксацию и сборка расстояний.
+// Процесс хранит только исходящие ребра своих вершин и их расстояния;
+// запросы к чужим вершинам копятся до конца шага и уходят одним
+// MPI_Alltoallv, а признаки завершения собираются MPI_Allreduce.
+namespace distributed {
+
+// Вершины [first, last) принадлежат процессу rank; блоки равны с
+// точностью до одной вершины, поэтому владелец считается без таблицы
+struct Partition {
+    int rank = 0;
+    int ranks = 1;
+    int vertices = 0;
+    int first = 0;
+    int last = 0;
+
+    static Partition block(int vertices, MPI_Comm comm) {
+        Partition partition;
+        MPI_Comm_rank(comm, &partition.rank);
+        MPI_Comm_size(comm, &partition.ranks);
+        partition.vertices = vertices;
+        partition.first = partition.begin_of(partition.rank);
+        partition.last = partition.begin_of(partition.rank + 1);
+        return partition;
+    }
+
+    int begin_of(int rank) const {
+        return static_cast<int>(static_cast<long long>(vertices) * rank / ranks);
+    }
+
+    int owner(int vertex) const {
+        // Первый процесс, чей блок начинается после vertex, минус один
+        int rank = static_cast<int>((static_cast<long long>(vertex) + 1) * ranks / vertices);
+        while (begin_of(rank) > vertex) {
+            --rank;
+        }
+        while (rank + 1 < ranks && begin_of(rank + 1) <= vertex) {
+            ++rank;
+        }
+        return rank;
+    }
+
+    bool owns(int vertex) const {
+        return vertex >= first && vertex < last;
+    }
+
+    int local_count() const {
+        return last - first;
+    }
+};
+
+// Строки своих вершин: номера строк локальные, концы ребер глобальные.
+// Читаются только offsets[first..last] и ребра этих строк, поэтому у
+// бинарного графа, отображенного в память без подкачки (binary_graph::load
+// с prefetch = false), процесс читает с диска только свой диапазон строк.
+// Такой файл загрузка целиком не проверяет, поэтому структура своих
+// строк проверяется здесь
+inline CSRGraph local_rows(const CSRGraph& graph, const Partition& partition) {
+    const size_t* offsets = graph.offsets();
+    if (!binary_graph::valid_rows(offsets, graph.targets(), graph.get_vertices(), graph.get_edges_count(),
+                                  partition.first, partition.last)) {
+        throw std::runtime_error("Graph rows are corrupted");
+    }
+    size_t begin = offsets[partition.first];
+    size_t end = offsets[partition.last];
+    std::vector<size_t> local_offsets(partition.local_count() + 1);
+    for (int v = 0; v <= partition.local_count(); ++v) {
+        local_offsets[v] = offsets[partition.first + v] - begin;
+    }
+    return CSRGraph(partition.local_count(), std::move(local_offsets),
+                    std::vector<int>(graph.targets() + begin, graph.targets() + end),
+                    std::vector<int>(graph.weights() + begin, graph.weights() + end));
+}
+
+// Запрос на релаксацию: новое расстояние до вершины
+struct Message {
+    int vertex;
+    int dist;
+};
+
+// Агрегированный обмен запросами. До отправки запросы каждому процессу
+// сжимаются до одного на вершину с наименьшим расстоянием, поэтому
+// объем обмена не больше числа различных затронутых вершин
+class RelaxExchange {
+    Partition partition;
+    MPI_Comm comm;
+    std::vector<std::vector<Message>> outbox;
+    std::vector<int> send_counts;
+    std::vector<int> recv_counts;
+    std::vector<int> send_displs;
+    std::vector<int> recv_displs;
+    std::vector<Message> send_buffer;
+    std::vector<Message> received;
+
+public:
+    RelaxExchange(const Partition& partition, MPI_Comm comm)
+        : partition(partition), comm(comm), outbox(partition.ranks), send_counts(partition.ranks),
+          recv_counts(partition.ranks), send_displs(partition.ranks), recv_displs(partition.ranks) {}
+
+    void push(int vertex, int dist) {
+        outbox[partition.owner(vertex)].push_back({vertex, dist});
+    }
+
+    // Коллективный вызов: все процессы отправляют накопленное и получают
+    // запросы к своим вершинам
+    const std::vector<Message>& exchange() {
+        send_buffer.clear();
+        for (int r = 0; r < partition.ranks; ++r) {
+            std::vector<Message>& messages = outbox[r];
+            std::sort(messages.begin(), messages.end(), [](const Message& a, const Message& b) {
+                return a.vertex != b.vertex ? a.vertex < b.vertex : a.dist < b.dist;
+            });
+            auto last = std::unique(messages.begin(), messages.end(), [](const Message& a, const Message& b) {
+                return a.vertex == b.vertex;
+            });
+            send_displs[r] = static_cast<int>(send_buffer.size());
+            send_counts[r] = static_cast<int>(last - messages.begin());
+            send_buffer.insert(send_buffer.end(), messages.begin(), last);
+            messages.clear();
+        }
+
+        MPI_Alltoall(send_counts.data(), 1, MPI_INT, recv_counts.data(), 1, MPI_INT, comm);
+        int total = 0;
+        for (int r = 0; r < partition.ranks; ++r) {
+            recv_displs[r] = total;
+            total += recv_counts[r];
+        }
+        received.resize(total);
+        // Пара int передается типом MPI_2INT
+        MPI_Alltoallv(send_buffer.data(), send_counts.data(), send_displs.data(), MPI_2INT,
+                      received.data(), recv_counts.data(), recv_displs.data(), MPI_2INT, comm);
+        return received;
+    }
+};
+
+// Сборка расстояний своих вершин в полный вектор на каждом процессе
+inline void gather_distances(const std::vector<int>& local, const Partition& partition, MPI_Comm comm, std::vector<int>& result) {
+    std::vector<int> counts(partition.ranks);
+    std::vector<int> displs(partition.ranks);
+    for (int r = 0; r < partition.ranks; ++r) {
+        displs[r] = partition.begin_of(r);
+        counts[r] = partition.begin_of(r + 1) - displs[r];
+    }
+    result.resize(partition.vertices);
+    MPI_Allgatherv(local.data(), partition.local_count(), MPI_INT,
+                   result.data(), counts.data(), displs.data(), MPI_INT, comm);
+}
+
+#ifdef SSSP_COUNTERS
+// Счетчики одного запроса на процессе 0: работа каждого процесса
+// добавляется в его ячейку threads (ячейка на процесс), размеры фронта
+// по раундам суммируются — раунды у всех процессов общие
+inline void add_counters(WorkCounters& work, const ThreadWork& local, const std::vector<long long>& round_sizes,
+                         const Partition& partition, MPI_Comm comm) {
+    std::vector<ThreadWork> per_rank(partition.rank == 0 ? partition.ranks : 0);
+    MPI_Gather(&local, sizeof(ThreadWork), MPI_BYTE, per_rank.data(), sizeof(ThreadWork), MPI_BYTE, 0, comm);
+    std::vector<long long> totals(round_sizes.size());
+    MPI_Reduce(round_sizes.data(), totals.data(), static_cast<int>(round_sizes.size()), MPI_LONG_LONG, MPI_SUM, 0, comm);
+    if (partition.rank != 0) {
+        return;
+    }
+    if (work.threads.size() < per_rank.size()) {
+        work.threads.resize(per_rank.size());
+    }
+    for (int r = 0; r < partition.ranks; ++r) {
+        work.threads[r].add(per_rank[r]);
+    }
+    for (long long size : totals) {
+        work.phase(static_cast<size_t>(size));
+    }
+}
+#endif
+
+// Значение процесса 0 на всех процессах: параметры, от которых зависит
+// последовательность коллективных вызовов, должны совпадать
+inline int from_rank_zero(int value, MPI_Comm comm) {
+    MPI_Bcast(&value, 1, MPI_INT, 0, comm);
+    return value;
+}
+
+// true, если условие выполнено хотя бы на одном процессе
+inline bool any(bool value, MPI_Comm comm) {
+    int local = value;
+    int global = 0;
+    MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_LOR, comm);
+    return global != 0;
+}
+
+// Вывод только с процесса 0, остальные процессы молчат
+inline void silence_other_ranks(MPI_Comm comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+    if (rank != 0) {
+        std::cout.setstate(std::ios::badbit);
+    }
+}
+
+// Аргументы командной строки процесса: граф и результаты замеров
+// записывает только процесс 0, остальные получают argv без --save и
+// --output FILE, чтобы не писать в одни и те же файлы одновременно
+inline std::vector<char*> rank_arguments(int argc, char* argv[], MPI_Comm comm) {
+    int rank = 0;
+    MPI_Comm_rank(comm, &rank);
+    std::vector<char*> arguments;
+    for (int i = 0; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (rank != 0 && arg == "--save") {
+            continue;
+        }
+        if (rank != 0 && arg == "--output" && i + 1 < argc) {
+            ++i;
+            continue;
+        }
+        arguments.push_back(argv[i]);
+    }
+    arguments.push_back(nullptr);
+    return arguments;
+}
+
+// Убирает из аргументов флаг, который разбирает сам main, а не Task;
+// true, если флаг был
+inline bool take_flag(std::vector<char*>& arguments, const std::string& flag) {
+    auto found = std::find_if(arguments.begin(), arguments.end(), [&](const char* arg) {
+        return arg && flag == arg;
+    });
+    if (found == arguments.end()) {
+        return false;
+    }
+    arguments.erase(found);
+    return true;
+}
+
+// Эталон на процессах, кроме 0: ничего не считает, все вершины
+// недостижимы. Список реализаций остается одинаковым на всех процессах,
+// поэтому порядок коллективных вызовов (подготовка и запросы движка MPI,
+// проба дельты) совпадает
+class IdleEngine : public SsspEngine {
+    std::vector<int> result;
+
+public:
+    explicit IdleEngine(const CSRGraph& graph) : result(graph.get_vertices(), INF) {}
+
+    const std::vector<int>& solve(int) override {
+        return result;
+    }
+};
+
+// Эталонная реализация считает весь граф, поэтому готовится только на
+// процессе 0, остальные процессы получают IdleEngine
+template <PrepareFn Prepare>
+EngineHandle on_rank_zero(const CSRGraph& graph, const EngineOptions& options) {
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (rank != 0) {
+        return std::make_unique<IdleEngine>(graph);
+    }
+    return Prepare(graph, options);
+}
+
+} // namespace distributed
@@ -0,0 +1,390 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+#include <vector>
+#include "graph.hpp"
+#include "engine.hpp"
+#include "dijkstra.hpp"
+#include "generators.hpp"
+#include "benchmark.hpp"
+
+// Динамические кратчайшие пути от одного источника: расстояния и дерево
+// кратчайших путей поддерживаются при вставке ребер и изменении весов.
+// После пакета изменений восстанавливается только затронутая область:
+//  - вставка ребра или уменьшение веса дают вершины, расстояние до которых
+//    сразу уменьшилось, и улучшение распространяется от них по Дейкстре;
+//  - увеличение веса или удаление ребра дерева делают недействительным
+//    поддерево его конца (как у Рамалингама-Репса): расстояния поддерева
+//    пересчитываются из незатронутых входящих соседей и дополняются той
+//    же волной Дейкстры.
+// Если недействительных вершин больше V / full_divisor, локальное
+// восстановление дороже пересчета с нуля (обход поддеревьев и входящих
+// дуг), и пакет завершается обычной Дейкстрой от источника.
+// Веса неотрицательны, дуги ориентированы (неориентированное ребро —
+// две дуги, каждая обновляется отдельно).
+namespace dynamic_sssp {
+
+struct EdgeUpdate {
+    enum Kind { Insert, Change, Remove };
+    Kind kind;
+    int from;
+    int to;
+    int weight;  // новый вес для Insert и Change
+};
+
+class DynamicSssp {
+    struct Arc {
+        int vertex;
+        int weight;
+    };
+
+    int source;
+    size_t full_threshold;
+    std::vector<std::vector<Arc>> out;
+    std::vector<std::vector<Arc>> in;
+    std::vector<int> dist;
+    std::vector<int> parent;
+    DaryHeap<4> heap;
+    std::vector<char> affected;
+    std::vector<int> affected_vertices;
+    std::vector<int> invalid_roots;
+    std::vector<int> seeds;
+    std::vector<int> stack;
+    std::vector<char> repaired;          // вершина пересчитана в текущем пакете
+    std::vector<int> repaired_vertices;
+    bool last_full = false;
+
+    int vertices() const {
+        return static_cast<int>(out.size());
+    }
+
+    void check_vertex(int v) const {
+        if (v < 0 || v >= vertices()) {
+            throw std::out_of_range("Vertex index out of range");
+        }
+    }
+
+    // Новое расстояние до v через дугу из u
+    bool shorten(int u, int v, int weight) {
+        if (dist[u] < INF && dist[u] + weight < dist[v]) {
+            dist[v] = dist[u] + weight;
+            parent[v] = u;
+            return true;
+        }
+        return false;
+    }
+
+    void improve(int u, int v, int weight) {
+        if (shorten(u, v, weight)) {
+            heap.push(v, dist[v]);
+        }
+    }
+
+    // Изменение веса всех дуг u -> v, возвращает прежний наименьший вес
+    int change_arcs(int u, int v, int weight) {
+        int old_weight = INF;
+        for (Arc& arc : out[u]) {
+            if (arc.vertex == v) {
+                old_weight = std::min(old_weight, arc.weight);
+                arc.weight = weight;
+            }
+        }
+        for (Arc& arc : in[v]) {
+            if (arc.vertex == u) {
+                arc.weight = weight;
+            }
+        }
+        return old_weight;
+    }
+
+    bool remove_arcs(int u, int v) {
+        auto from_u = [v](const Arc& arc) { return arc.vertex == v; };
+        auto into_v = [u](const Arc& arc) { return arc.vertex == u; };
+        size_t before = out[u].size();
+        out[u].erase(std::remove_if(out[u].begin(), out[u].end(), from_u), out[u].end());
+        in[v].erase(std::remove_if(in[v].begin(), in[v].end(), into_v), in[v].end());
+        return out[u].size() != before;
+    }
+
+    void mark_repaired(int v) {
+        if (!repaired[v]) {
+            repaired[v] = 1;
+            repaired_vertices.push_back(v);
+        }
+    }
+
+    // Число различных пересчитанных вершин с последнего вызова
+    size_t take_repaired() {
+        size_t count = repaired_vertices.size();
+        for (int v : repaired_vertices) {
+            repaired[v] = 0;
+        }
+        repaired_vertices.clear();
+        return count;
+    }
+
+    // Волна Дейкстры от вершин в очереди
+    void propagate() {
+        while (!heap.empty()) {
+            int u = heap.pop().second;
+            mark_repaired(u);
+            for (const Arc& arc : out[u]) {
+                improve(u, arc.vertex, arc.weight);
+            }
+        }
+    }
+
+public:
+    DynamicSssp(const CSRGraph& graph, int source, int full_divisor = 4)
+        : source(source), out(graph.get_vertices()), in(graph.get_vertices()),
+          dist(graph.get_vertices()), parent(graph.get_vertices()),
+          heap(graph.get_vertices()), affected(graph.get_vertices(), 0), repaired(graph.get_vertices(), 0) {
+        check_vertex(source);
+        if (full_divisor <= 0) {
+            throw std::invalid_argument("Full recompute divisor must be positive");
+        }
+        full_threshold = static_cast<size_t>(graph.get_vertices()) / full_divisor;
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+        for (int u = 0; u < graph.get_vertices(); ++u) {
+            for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+                if (weights[e] < 0) {
+                    throw std::invalid_argument("Dynamic SSSP requires non-negative edge weights");
+                }
+                out[u].push_back({targets[e], weights[e]});
+                in[targets[e]].push_back({u, weights[e]});
+            }
+        }
+        recompute();
+    }
+
+    // Пересчет с нуля, возвращает число достижимых вершин
+    size_t recompute() {
+        std::fill(dist.begin(), dist.end(), INF);
+        std::fill(parent.begin(), parent.end(), -1);
+        heap.clear();
+        dist[source] = 0;
+        heap.push(source, 0);
+        propagate();
+        return take_repaired();
+    }
+
+    // Применение пакета изменений и восстановление расстояний; возвращает
+    // число различных пересчитанных вершин (недействительных и получивших
+    // новое расстояние), при пересчете с нуля — всех достижимых
+    size_t apply(const std::vector<EdgeUpdate>& updates) {
+        last_full = false;
+        invalid_roots.clear();
+        seeds.clear();
+        for (const EdgeUpdate& update : updates) {
+            int u = update.from;
+            int v = update.to;
+            check_vertex(u);
+            check_vertex(v);
+            if (update.kind != EdgeUpdate::Remove && update.weight < 0) {
+                throw std::invalid_argument("Dynamic SSSP requires non-negative edge weights");
+            }
+            switch (update.kind) {
+                case EdgeUpdate::Insert:
+                    out[u].push_back({v, update.weight});
+                    in[v].push_back({u, update.weight});
+                    if (shorten(u, v, update.weight)) {
+                        seeds.push_back(v);
+                    }
+                    break;
+                case EdgeUpdate::Change: {
+                    int old_weight = change_arcs(u, v, update.weight);
+                    if (old_weight == INF) {
+                        throw std::invalid_argument("Edge does not exist");
+                    }
+                    if (update.weight < old_weight) {
+                        if (shorten(u, v, update.weight)) {
+                            seeds.push_back(v);
+                        }
+                    } else if (update.weight > old_weight && parent[v] == u) {
+                        invalid_roots.push_back(v);
+                    }
+                    break;
+                }
+                case EdgeUpdate::Remove:
+                    if (!remove_arcs(u, v)) {
+                        throw std::invalid_argument("Edge does not exist");
+                    }
+                    if (parent[v] == u) {
+                        invalid_roots.push_back(v);
+                    }
+                    break;
+            }
+        }
+
+        // Поддеревья недействительных вершин по текущим ссылкам на родителя
+        affected_vertices.clear();
+        for (int root : invalid_roots) {
+            if (affected[root]) {
+                continue;
+            }
+            affected[root] = 1;
+            stack.push_back(root);
+            while (!stack.empty()) {
+                int x = stack.back();
+                stack.pop_back();
+                affected_vertices.push_back(x);
+                for (const Arc& arc : out[x]) {
+                    if (parent[arc.vertex] == x && !affected[arc.vertex]) {
+                        affected[arc.vertex] = 1;
+                        stack.push_back(arc.vertex);
+                    }
+                }
+            }
+        }
+        if (affected_vertices.size() > full_threshold) {
+            for (int x : affected_vertices) {
+                affected[x] = 0;
+            }
+            last_full = true;
+            return recompute();
+        }
+        for (int x : affected_vertices) {
+            dist[x] = INF;
+            parent[x] = -1;
+            mark_repaired(x);
+        }
+        // Оценки затронутых вершин по незатронутым входящим соседям
+        for (int x : affected_vertices) {
+            for (const Arc& arc : in[x]) {
+                if (!affected[arc.vertex]) {
+                    improve(arc.vertex, x, arc.weight);
+                }
+            }
+        }
+        // Вершины с уменьшившимся расстоянием вне недействительных поддеревьев
+        for (int v : seeds) {
+            if (!affected[v]) {
+                heap.push(v, dist[v]);
+            }
+        }
+        for (int x : affected_vertices) {
+            affected[x] = 0;
+        }
+
+        propagate();
+        return take_repaired();
+    }
+
+    // Последний apply пересчитал расстояния с нуля
+    bool recomputed_fully() const {
+        return last_full;
+    }
+
+    const std::vector<int>& distances() const {
+        return dist;
+    }
+
+    // Родитель в дереве кратчайших путей, -1 для источника и недостижимых
+    const std::vector<int>& parents() const {
+        return parent;
+    }
+
+    // Текущий граф в формате CSR, например для проверки пересчетом с нуля
+    CSRGraph to_csr() const {
+        std::vector<Edge> edges;
+        for (int u = 0; u < vertices(); ++u) {
+            for (const Arc& arc : out[u]) {
+                edges.push_back({u, arc.vertex, arc.weight});
+            }
+        }
+        return CSRGraph::from_edges(vertices(), edges);
+    }
+
+    // Случайный пакет: вставки, уменьшения и увеличения весов, удаления
+    // поровну; веса вставок — из [1, max_weight]. Каждая существующая дуга
+    // меняется в пакете не больше одного раза
+    std::vector<EdgeUpdate> random_updates(size_t count, int max_weight, graph_generators::Rng& rng) const {
+        std::vector<EdgeUpdate> updates;
+        std::unordered_set<uint64_t> touched;
+        int n = vertices();
+        while (updates.size() < count) {
+            int kind = static_cast<int>(rng.below(4));
+            int u = static_cast<int>(rng.below(n));
+            if (kind == 0 || out[u].empty()) {
+                int v = static_cast<int>(rng.below(n));
+                updates.push_back({EdgeUpdate::Insert, u, v, 1 + static_cast<int>(rng.below(max_weight))});
+                continue;
+            }
+            const Arc& arc = out[u][rng.below(out[u].size())];
+            if (!touched.insert(static_cast<uint64_t>(u) << 32 | static_cast<uint32_t>(arc.vertex)).second) {
+                continue;
+            }
+            if (kind == 1) {
+                updates.push_back({EdgeUpdate::Change, u, arc.vertex, arc.weight / 2});
+            } else if (kind == 2) {
+                updates.push_back({EdgeUpdate::Change, u, arc.vertex, std::min(arc.weight * 2 + 1, max_weight * 2)});
+            } else {
+                updates.push_back({EdgeUpdate::Remove, u, arc.vertex, 0});
+            }
+        }
+        return updates;
+    }
+};
+
+// Замер восстановления после repeat пакетов по batch изменений против
+// пересчета алгоритмом Дейкстры с нуля; результат сверяется после каждого пакета
+inline std::vector<benchmark::Record> benchmark_updates(const CSRGraph& graph, const std::string& graph_name, int source,
+                                                        size_t batch, int repeat, uint64_t seed) {
+    DynamicSssp dynamic(graph, source);
+    const int* weights = graph.weights();
+    int max_weight = std::max(1, graph.get_edges_count() ? *std::max_element(weights, weights + graph.get_edges_count()) : 1);
+    graph_generators::Rng rng(seed, 0x64796eull);
+
+    benchmark::Record update_record;
+    update_record.impl_name = "Dynamic";
+    update_record.key = "dynamic";
+    benchmark::Record full_record;
+    full_record.impl_name = "Dijkstra";
+    full_record.key = "dijkstra";
+
+    for (int i = 0; i < repeat; ++i) {
+        std::vector<EdgeUpdate> updates = dynamic.random_updates(batch, max_weight, rng);
+        auto start = std::chrono::high_resolution_clock::now();
+        size_t repaired = dynamic.apply(updates);
+        auto stop = std::chrono::high_resolution_clock::now();
+        double update_time = std::chrono::duration<double>(stop - start).count();
+
+        Dijkstra<RadixHeap> reference(dynamic.to_csr(), EngineOptions{});
+        start = std::chrono::high_resolution_clock::now();
+        const std::vector<int>& expected = reference.solve(source);
+        stop = std::chrono::high_resolution_clock::now();
+        double full_time = std::chrono::duration<double>(stop - start).count();
+
+        std::cout << "Пакет " << i + 1 << ": обновление " << std::fixed << std::setprecision(6) << update_time
+                  << " секунд (пересчитано вершин: " << repaired << (dynamic.recomputed_fully() ? ", с нуля" : "")
+                  << "), пересчет с нуля " << full_time << " секунд" << std::endl;
+        if (expected != dynamic.distances()) {
+            std::cout << "Результаты не совпадают" << std::endl;
+        }
+        update_record.samples.push_back(update_time);
+        full_record.samples.push_back(full_time);
+    }
+
+    std::vector<benchmark::Record> records;
+    for (benchmark::Record* record : {&update_record, &full_record}) {
+        record->graph = graph_name;
+        record->vertices = graph.get_vertices();
+        record->edges = graph.get_edges_count();
+        record->threads = 1;
+        record->sources = 1;
+        record->stats = benchmark::Stats::compute(record->samples);
+        benchmark::print_record(*record);
+        records.push_back(*record);
+    }
+    return records;
+}
+
+} // namespace dynamic_sssp
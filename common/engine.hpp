@@ -0,0 +1,84 @@
+#pragma once
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "counters.hpp"
+
+// Параметры подготовки движка
+struct EngineOptions {
+    int delta = 10; // ширина ведра дельта-шага
+    int lanes = 32; // число источников в одном проходе пакетного движка
+    std::string simd = "auto"; // векторное ядро: auto, scalar, avx2, avx512
+    std::string heap = "radix"; // очередь Дейкстры: binary, 4ary, pairing, radix
+    bool parents = false; // строить дерево кратчайших путей (см. parents())
+};
+
+// Движок кратчайших путей с раздельными фазами: конструктор (prepare)
+// один раз строит производные структуры графа и рабочие буферы, а solve
+// переиспользует их для каждого запроса без выделения памяти.
+// Движок хранит копию CSRGraph, поэтому граф живет не меньше движка.
+class SsspEngine {
+public:
+    virtual ~SsspEngine() = default;
+
+    // Расстояния от source; ссылка действительна до следующего вызова solve
+    virtual const std::vector<int>& solve(int source) = 0;
+
+    // Расстояния от нескольких источников: out[i * V + v] — расстояние
+    // от sources[i] до v, out уже имеет размер sources.size() * V.
+    // По умолчанию источники обрабатываются по одному
+    virtual void solve_batch(const std::vector<int>& sources, std::vector<int>& out) {
+        for (size_t i = 0; i < sources.size(); ++i) {
+            const std::vector<int>& dist = solve(sources[i]);
+            std::copy(dist.begin(), dist.end(), out.begin() + i * dist.size());
+        }
+    }
+
+    // Счетчики работы с последнего reset(); nullptr, если движок их не
+    // ведет или программа собрана без -DSSSP_COUNTERS
+    virtual WorkCounters* counters() {
+        return nullptr;
+    }
+
+    // Предки вершин в дереве кратчайших путей последнего solve (-1 у
+    // источника и недостижимых вершин); nullptr, если движок не строит
+    // дерево или EngineOptions::parents выключен
+    virtual const std::vector<int>* parents() {
+        return nullptr;
+    }
+
+protected:
+    // Без -DSSSP_COUNTERS счетчиков нет вовсе: ни поля, ни их передачи в ядра
+    SSSP_COUNT(WorkCounters work;)
+
+    template <typename Graph>
+    static void check_source(const Graph& graph, int source) {
+        if (source < 0 || source >= graph.get_vertices()) {
+            throw std::out_of_range("Source vertex is out of range");
+        }
+    }
+};
+
+// Граф не подходит движку (например, отрицательные веса у Дейкстры):
+// Task пропускает такую реализацию, а не прерывает весь запуск
+class UnsupportedGraph : public std::invalid_argument {
+public:
+    using std::invalid_argument::invalid_argument;
+};
+
+using EngineHandle = std::unique_ptr<SsspEngine>;
+using PrepareFn = EngineHandle (*)(const CSRGraph& graph, const EngineOptions& options);
+
+// Подготовка движка Engine к серии запросов на графе graph
+template <typename Engine>
+EngineHandle prepare(const CSRGraph& graph, const EngineOptions& options) {
+    return std::make_unique<Engine>(graph, options);
+}
+
+inline const std::vector<int>& solve(SsspEngine& engine, int source) {
+    return engine.solve(source);
+}
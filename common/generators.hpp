@@ -0,0 +1,428 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+
+// Параллельные генераторы случайных графов с фиксированным зерном.
+// Работа делится на блоки фиксированного размера, и у каждого блока свой
+// поток случайных чисел, выведенный из (seed, номер блока). Поэтому граф
+// зависит только от параметров и зерна, но не от числа потоков.
+// Все генераторы строят неориентированные графы: каждое ребро хранится
+// в списке один раз, обратные дуги добавляет Graph::to_csr.
+namespace graph_generators {
+
+// Генератор SplitMix64: быстрый, с независимыми потоками по номеру блока
+class Rng {
+private:
+    uint64_t state;
+
+public:
+    Rng(uint64_t seed, uint64_t stream) : state(seed ^ (stream * 0xd1342543de82ef95ull + 0x9e3779b97f4a7c15ull)) {
+        next();
+    }
+
+    uint64_t next() {
+        uint64_t z = (state += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // Равномерное число в [0, 1)
+    double uniform() {
+        return static_cast<double>(next() >> 11) * 0x1.0p-53;
+    }
+
+    // Равномерное целое в [0, bound)
+    uint64_t below(uint64_t bound) {
+        return static_cast<uint64_t>((static_cast<unsigned __int128>(next()) * bound) >> 64);
+    }
+};
+
+// Распределение весов ребер. Спецификация задается строкой:
+//   uniform:A:B     — равномерно на [A, B] (по умолчанию uniform:1:100)
+//   const:W         — все веса равны W
+//   exp:M           — экспоненциальное со средним M, округленное вверх до >= 1
+//   loguniform:A:B  — логарифм веса равномерен на [log A, log B]
+struct WeightDistribution {
+    enum class Kind { Uniform, Constant, Exponential, LogUniform };
+
+    Kind kind = Kind::Uniform;
+    double a = 1;
+    double b = 100;
+
+    static WeightDistribution parse(const std::string& spec) {
+        std::vector<std::string> parts;
+        size_t start = 0;
+        while (true) {
+            size_t colon = spec.find(':', start);
+            parts.push_back(spec.substr(start, colon - start));
+            if (colon == std::string::npos) break;
+            start = colon + 1;
+        }
+
+        WeightDistribution result;
+        auto number = [&](size_t i) {
+            if (i >= parts.size()) throw std::invalid_argument("Missing parameter in weight distribution: " + spec);
+            return std::stod(parts[i]);
+        };
+        if (parts[0] == "uniform" && parts.size() == 3) {
+            result = {Kind::Uniform, number(1), number(2)};
+        } else if (parts[0] == "const" && parts.size() == 2) {
+            result = {Kind::Constant, number(1), number(1)};
+        } else if (parts[0] == "exp" && parts.size() == 2) {
+            result = {Kind::Exponential, number(1), 0};
+        } else if (parts[0] == "loguniform" && parts.size() == 3) {
+            result = {Kind::LogUniform, number(1), number(2)};
+        } else {
+            throw std::invalid_argument("Unknown weight distribution: " + spec);
+        }
+        if (result.kind != Kind::Exponential && result.a > result.b) {
+            throw std::invalid_argument("Empty weight range: " + spec);
+        }
+        if ((result.kind == Kind::LogUniform || result.kind == Kind::Exponential) && result.a <= 0) {
+            throw std::invalid_argument("Weight distribution parameter must be positive: " + spec);
+        }
+        if (std::max(std::abs(result.a), std::abs(result.b)) > std::numeric_limits<int>::max()) {
+            throw std::invalid_argument("Weights must fit into int: " + spec);
+        }
+        // Веса целые: диапазон без целого числа (uniform:1.5:1.7) пуст
+        if (result.kind != Kind::Exponential && std::ceil(result.a) > std::floor(result.b)) {
+            throw std::invalid_argument("Weight range contains no integer: " + spec);
+        }
+        return result;
+    }
+
+    int sample(Rng& rng) const {
+        switch (kind) {
+            case Kind::Uniform: {
+                long long low = static_cast<long long>(std::ceil(a));
+                long long high = static_cast<long long>(std::floor(b));
+                return static_cast<int>(low + static_cast<long long>(rng.below(static_cast<uint64_t>(high - low + 1))));
+            }
+            case Kind::Constant:
+                return static_cast<int>(a);
+            case Kind::Exponential: {
+                double value = std::ceil(-a * std::log1p(-rng.uniform()));
+                return static_cast<int>(std::min(std::max(value, 1.0), static_cast<double>(std::numeric_limits<int>::max())));
+            }
+            case Kind::LogUniform: {
+                double value = std::round(std::exp(std::log(a) + (std::log(b) - std::log(a)) * rng.uniform()));
+                return static_cast<int>(std::min(std::max(value, std::ceil(a)), std::floor(b)));
+            }
+        }
+        return 1;
+    }
+};
+
+// Выполнение блоков генерации параллельно и слияние их ребер в порядке блоков
+template <typename BlockGenerator>
+std::vector<Edge> generate_blocks(uint64_t blocks, BlockGenerator generate_block) {
+    std::vector<std::vector<Edge>> block_edges(blocks);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (uint64_t b = 0; b < blocks; ++b) {
+        generate_block(b, block_edges[b]);
+    }
+
+    std::vector<size_t> positions(blocks + 1, 0);
+    for (uint64_t b = 0; b < blocks; ++b) {
+        positions[b + 1] = positions[b] + block_edges[b].size();
+    }
+    std::vector<Edge> edges(positions[blocks]);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (uint64_t b = 0; b < blocks; ++b) {
+        std::copy(block_edges[b].begin(), block_edges[b].end(), edges.begin() + positions[b]);
+        std::vector<Edge>().swap(block_edges[b]);
+    }
+    return edges;
+}
+
+// Случайная перестановка номеров вершин, чтобы номер не коррелировал со степенью
+inline std::vector<int> random_permutation(int vertices, uint64_t seed) {
+    std::vector<int> permutation(vertices);
+    std::iota(permutation.begin(), permutation.end(), 0);
+    Rng rng(seed, 0xfffffffffffffull);
+    for (int i = vertices - 1; i > 0; --i) {
+        std::swap(permutation[i], permutation[rng.below(static_cast<uint64_t>(i) + 1)]);
+    }
+    return permutation;
+}
+
+inline void add_undirected(std::vector<Edge>& edges, int u, int v, int weight) {
+    edges.push_back({u, v, weight});
+}
+
+// G(n, p) с геометрическими пропусками (Batagelj–Brandes):
+// время O(n + m) вместо перебора всех n² пар
+inline Graph gnp(int vertices, double probability, const WeightDistribution& weights, uint64_t seed) {
+    const int rows_per_block = 256;
+    uint64_t blocks = (static_cast<uint64_t>(vertices) + rows_per_block - 1) / rows_per_block;
+    double log_q = std::log1p(-probability);
+
+    std::vector<Edge> edges = generate_blocks(blocks, [&](uint64_t block, std::vector<Edge>& out) {
+        Rng rng(seed, block);
+        int first = static_cast<int>(block * rows_per_block);
+        int last = std::min(vertices, first + rows_per_block);
+        for (int i = first; i < last; ++i) {
+            long long j = i;
+            while (true) {
+                if (probability < 1) {
+                    double skip = std::floor(std::log1p(-rng.uniform()) / log_q);
+                    j += 1 + static_cast<long long>(std::min(skip, static_cast<double>(vertices)));
+                } else {
+                    j += 1;
+                }
+                if (j >= vertices) break;
+                add_undirected(out, i, static_cast<int>(j), weights.sample(rng));
+            }
+        }
+    });
+    return Graph(vertices, std::move(edges));
+}
+
+// R-MAT / Kronecker в стиле Graph500: 2^scale вершин, edge_factor * 2^scale ребер,
+// вероятности квадрантов a, b, c и d = 1 - a - b - c. Петли отбрасываются.
+inline Graph rmat(int scale, int edge_factor, double a, double b, double c, const WeightDistribution& weights, uint64_t seed) {
+    if (scale < 1 || scale > 30) {
+        throw std::invalid_argument("R-MAT scale must be in [1, 30]");
+    }
+    const uint64_t edges_per_block = 1 << 16;
+    int vertices = 1 << scale;
+    uint64_t total = static_cast<uint64_t>(edge_factor) << scale;
+    uint64_t blocks = (total + edges_per_block - 1) / edges_per_block;
+    std::vector<int> permutation = random_permutation(vertices, seed);
+
+    std::vector<Edge> edges = generate_blocks(blocks, [&](uint64_t block, std::vector<Edge>& out) {
+        Rng rng(seed, block);
+        uint64_t count = std::min(edges_per_block, total - block * edges_per_block);
+        for (uint64_t e = 0; e < count; ++e) {
+            int u = 0, v = 0;
+            for (int level = 0; level < scale; ++level) {
+                double r = rng.uniform();
+                int bit = 1 << level;
+                if (r < a) {
+                } else if (r < a + b) {
+                    v |= bit;
+                } else if (r < a + b + c) {
+                    u |= bit;
+                } else {
+                    u |= bit;
+                    v |= bit;
+                }
+            }
+            int weight = weights.sample(rng);
+            if (u != v) {
+                add_undirected(out, permutation[u], permutation[v], weight);
+            }
+        }
+    });
+    return Graph(vertices, std::move(edges));
+}
+
+// Двумерная решетка rows x cols с 4-соседством — модель дорожной сети
+// с большим диаметром. Каждое ребро решетки присутствует с вероятностью keep.
+inline Graph grid(int rows, int cols, double keep, const WeightDistribution& weights, uint64_t seed) {
+    if (rows <= 0 || cols <= 0 || static_cast<long long>(rows) * cols > std::numeric_limits<int>::max()) {
+        throw std::invalid_argument("Invalid grid size");
+    }
+    int vertices = rows * cols;
+    std::vector<Edge> edges = generate_blocks(static_cast<uint64_t>(rows), [&](uint64_t row, std::vector<Edge>& out) {
+        Rng rng(seed, row);
+        int r = static_cast<int>(row);
+        for (int col = 0; col < cols; ++col) {
+            int u = r * cols + col;
+            if (col + 1 < cols && rng.uniform() < keep) {
+                add_undirected(out, u, u + 1, weights.sample(rng));
+            }
+            if (r + 1 < rows && rng.uniform() < keep) {
+                add_undirected(out, u, u + cols, weights.sample(rng));
+            }
+        }
+    });
+    return Graph(vertices, std::move(edges));
+}
+
+// Степенной граф по модели Чунга–Лу: ожидаемая степень вершины i
+// пропорциональна (i + 1)^(-1 / (gamma - 1)), средняя степень равна average_degree.
+// Концы ребер выбираются пропорционально ожидаемым степеням.
+inline Graph power_law(int vertices, double average_degree, double gamma, const WeightDistribution& weights, uint64_t seed) {
+    if (gamma <= 2) {
+        throw std::invalid_argument("Power-law exponent must be greater than 2");
+    }
+    const uint64_t edges_per_block = 1 << 16;
+    std::vector<double> cumulative(vertices);
+    double exponent = -1.0 / (gamma - 1.0);
+    double sum = 0;
+    for (int i = 0; i < vertices; ++i) {
+        sum += std::pow(static_cast<double>(i + 1), exponent);
+        cumulative[i] = sum;
+    }
+    uint64_t total = static_cast<uint64_t>(average_degree * vertices / 2);
+    uint64_t blocks = (total + edges_per_block - 1) / edges_per_block;
+    std::vector<int> permutation = random_permutation(vertices, seed);
+
+    auto pick = [&](Rng& rng) {
+        double r = rng.uniform() * sum;
+        auto it = std::upper_bound(cumulative.begin(), cumulative.end(), r);
+        return permutation[std::min<long>(it - cumulative.begin(), vertices - 1)];
+    };
+
+    std::vector<Edge> edges = generate_blocks(blocks, [&](uint64_t block, std::vector<Edge>& out) {
+        Rng rng(seed, block);
+        uint64_t count = std::min(edges_per_block, total - block * edges_per_block);
+        for (uint64_t e = 0; e < count; ++e) {
+            int u = pick(rng);
+            int v = pick(rng);
+            int weight = weights.sample(rng);
+            if (u != v) {
+                add_undirected(out, u, v, weight);
+            }
+        }
+    });
+    return Graph(vertices, std::move(edges));
+}
+
+// Параметры генерации из командной строки, общие для всех задач
+struct GeneratorOptions {
+    std::string generator = "gnp";
+    int vertices;
+    double edge_probability;
+    bool probability_given = false;
+    int scale = 16;
+    int edge_factor = 16;
+    double rmat_a = 0.57, rmat_b = 0.19, rmat_c = 0.19;
+    double average_degree = 16;
+    double gamma = 2.5;
+    WeightDistribution weights;
+    std::string weights_spec = "uniform:1:100";
+    uint64_t seed = 1;
+
+    GeneratorOptions(int vertices, double edge_probability) : vertices(vertices), edge_probability(edge_probability) {}
+
+    // Разбор одной опции. Возвращает 1, если опция распознана, 0 — если нет,
+    // -1 — при ошибке (сообщение уже выведено)
+    int parse_arg(int& i, int argc, char* argv[]) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            return 0;
+        }
+        try {
+            if (arg == "--vertices") {
+                vertices = std::atoi(argv[++i]);
+                if (vertices <= 0) {
+                    std::cerr << "Ошибка: количество вершин должно быть положительным числом" << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--prob") {
+                edge_probability = std::atof(argv[++i]);
+                probability_given = true;
+                if (edge_probability <= 0 || edge_probability > 1) {
+                    std::cerr << "Ошибка: вероятность ребра должна быть в диапазоне (0, 1]" << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--generator") {
+                generator = argv[++i];
+                if (generator != "gnp" && generator != "rmat" && generator != "grid" && generator != "powerlaw") {
+                    std::cerr << "Ошибка: неизвестный генератор " << generator << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--seed") {
+                seed = std::stoull(argv[++i]);
+            } else if (arg == "--weights") {
+                weights_spec = argv[++i];
+                weights = WeightDistribution::parse(weights_spec);
+            } else if (arg == "--scale") {
+                scale = std::atoi(argv[++i]);
+                if (scale < 1 || scale > 30) {
+                    std::cerr << "Ошибка: масштаб rmat должен быть в диапазоне [1, 30]" << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--edge-factor") {
+                edge_factor = std::atoi(argv[++i]);
+                if (edge_factor <= 0) {
+                    std::cerr << "Ошибка: число ребер на вершину должно быть положительным числом" << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--degree") {
+                average_degree = std::atof(argv[++i]);
+                if (!(average_degree > 0)) {
+                    std::cerr << "Ошибка: средняя степень powerlaw должна быть положительным числом" << std::endl;
+                    return -1;
+                }
+            } else if (arg == "--gamma") {
+                gamma = std::atof(argv[++i]);
+                if (!(gamma > 2)) {
+                    std::cerr << "Ошибка: показатель powerlaw должен быть больше 2" << std::endl;
+                    return -1;
+                }
+            } else {
+                return 0;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка: " << e.what() << std::endl;
+            return -1;
+        }
+        return 1;
+    }
+
+    // Почти квадратная решетка не больше vertices вершин
+    std::pair<int, int> grid_shape() const {
+        int rows = std::max(1, static_cast<int>(std::sqrt(static_cast<double>(vertices))));
+        return {rows, std::max(1, vertices / rows)};
+    }
+
+    Graph generate() const {
+        if (generator == "rmat") {
+            return rmat(scale, edge_factor, rmat_a, rmat_b, rmat_c, weights, seed);
+        }
+        if (generator == "grid") {
+            auto [rows, cols] = grid_shape();
+            return grid(rows, cols, probability_given ? edge_probability : 1.0, weights, seed);
+        }
+        if (generator == "powerlaw") {
+            return power_law(vertices, average_degree, gamma, weights, seed);
+        }
+        return gnp(vertices, edge_probability, weights, seed);
+    }
+
+    std::string describe() const {
+        std::string result = "генератор: " + generator;
+        if (generator == "rmat") {
+            result += ", масштаб: " + std::to_string(scale) + ", ребер на вершину: " + std::to_string(edge_factor);
+        } else if (generator == "powerlaw") {
+            result += ", количество вершин: " + std::to_string(vertices) + ", средняя степень: " + std::to_string(average_degree)
+                + ", показатель: " + std::to_string(gamma);
+        } else if (generator == "grid") {
+            auto [rows, cols] = grid_shape();
+            result += ", решетка: " + std::to_string(rows) + "x" + std::to_string(cols)
+                + ", количество вершин: " + std::to_string(rows * cols);
+        } else {
+            result += ", количество вершин: " + std::to_string(vertices) + ", вероятность ребра: " + std::to_string(edge_probability);
+        }
+        return result + ", веса: " + weights_spec + ", зерно: " + std::to_string(seed);
+    }
+
+    static void print_usage() {
+        std::cout << "  --generator G   Генератор: gnp, rmat, grid, powerlaw (по умолчанию gnp)" << std::endl;
+        std::cout << "  --seed S        Зерно генератора (по умолчанию 1)" << std::endl;
+        std::cout << "  --weights W     Веса: uniform:A:B, const:W, exp:M, loguniform:A:B (по умолчанию uniform:1:100)" << std::endl;
+        std::cout << "  --scale S       rmat: 2^S вершин (по умолчанию 16)" << std::endl;
+        std::cout << "  --edge-factor K rmat: ребер на вершину (по умолчанию 16)" << std::endl;
+        std::cout << "  --degree D      powerlaw: средняя степень (по умолчанию 16)" << std::endl;
+        std::cout << "  --gamma G       powerlaw: показатель степенного закона (по умолчанию 2.5)" << std::endl;
+        std::cout << "  Для grid --prob задает вероятность сохранить ребро решетки (по умолчанию 1)" << std::endl;
+    }
+};
+
+}
@@ -1,23 +1,338 @@
 #pragma once
 
 #include <vector>
-#include <random>
 #include <fstream>
 #include <string>
 #include <stdexcept>
+#include <limits>
+#include <memory>
+#include <algorithm>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
 
 struct Edge {
     int from, to, weight;
 };
 
+// Граф в формате CSR (compressed sparse row): ребра вершины u лежат
+// в диапазоне [offsets[u], offsets[u + 1]) массивов targets и weights.
+// Массивы неизменяемы, поэтому копии графа разделяют одну и ту же память.
+// Неориентированный граф хранится с ребрами в обоих направлениях и
+// помечается флагом undirected (is_undirected); одна копия каждого
+// ребра — single_copy().
+class CSRGraph {
+private:
+    struct Storage {
+        std::vector<size_t> offsets;
+        std::vector<int> targets;
+        std::vector<int> weights;
+    };
+
+    int vertices = 0;
+    size_t edges_count = 0;
+    const size_t* offsets_ptr = nullptr;
+    const int* targets_ptr = nullptr;
+    const int* weights_ptr = nullptr;
+    std::shared_ptr<const void> storage;
+    bool undirected = false;
+
+public:
+    CSRGraph() = default;
+
+    // Создание графа из готовых массивов CSR
+    CSRGraph(int num_vertices, std::vector<size_t> offsets, std::vector<int> targets, std::vector<int> weights) {
+        if (num_vertices < 0 || offsets.size() != static_cast<size_t>(num_vertices) + 1
+            || targets.size() != weights.size() || offsets.back() != targets.size()) {
+            throw std::invalid_argument("Inconsistent CSR arrays");
+        }
+        auto owned = std::make_shared<Storage>(Storage{std::move(offsets), std::move(targets), std::move(weights)});
+        vertices = num_vertices;
+        edges_count = owned->targets.size();
+        offsets_ptr = owned->offsets.data();
+        targets_ptr = owned->targets.data();
+        weights_ptr = owned->weights.data();
+        storage = std::move(owned);
+    }
+
+    // Представление чужих массивов CSR без копирования; owner продлевает
+    // время жизни памяти, в которой они лежат (например, отображенного файла)
+    CSRGraph(int num_vertices, size_t num_edges, const size_t* offsets, const int* targets, const int* weights, std::shared_ptr<const void> owner)
+        : vertices(num_vertices), edges_count(num_edges),
+          offsets_ptr(offsets), targets_ptr(targets), weights_ptr(weights),
+          storage(std::move(owner)) {}
+
+    // Параллельное построение CSR из списка ребер.
+    // Ребра каждой вершины упорядочены по (to, weight), поэтому результат
+    // не зависит от числа потоков.
+    static CSRGraph from_edges(int num_vertices, const std::vector<Edge>& edges) {
+        const size_t num_edges = edges.size();
+        const Edge* edges_ptr = edges.data();
+
+        bool invalid = false;
+        #pragma omp parallel for reduction(||:invalid)
+        for (size_t i = 0; i < num_edges; ++i) {
+            invalid = invalid || edges_ptr[i].from < 0 || edges_ptr[i].from >= num_vertices
+                || edges_ptr[i].to < 0 || edges_ptr[i].to >= num_vertices;
+        }
+        if (invalid) {
+            throw std::out_of_range("Vertex index out of range");
+        }
+
+        // Подсчет степеней вершин
+        std::vector<size_t> offsets(static_cast<size_t>(num_vertices) + 1, 0);
+        size_t* offsets_data = offsets.data();
+        #pragma omp parallel for
+        for (size_t i = 0; i < num_edges; ++i) {
+            #pragma omp atomic
+            offsets_data[edges_ptr[i].from + 1]++;
+        }
+        for (int u = 0; u < num_vertices; ++u) {
+            offsets[u + 1] += offsets[u];
+        }
+
+        // Раскладка ребер по строкам: цель и вес упакованы в один ключ,
+        // чтобы строку можно было отсортировать без дополнительной памяти
+        std::vector<size_t> cursor(offsets.begin(), offsets.end() - 1);
+        std::vector<uint64_t> packed(num_edges);
+        size_t* cursor_data = cursor.data();
+        uint64_t* packed_data = packed.data();
+        #pragma omp parallel for
+        for (size_t i = 0; i < num_edges; ++i) {
+            size_t position;
+            #pragma omp atomic capture
+            position = cursor_data[edges_ptr[i].from]++;
+            packed_data[position] = (static_cast<uint64_t>(edges_ptr[i].to) << 32)
+                | (static_cast<uint32_t>(edges_ptr[i].weight) ^ 0x80000000u);
+        }
+
+        std::vector<int> targets(num_edges);
+        std::vector<int> weights(num_edges);
+        int* targets_data = targets.data();
+        int* weights_data = weights.data();
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int u = 0; u < num_vertices; ++u) {
+            std::sort(packed_data + offsets_data[u], packed_data + offsets_data[u + 1]);
+            for (size_t e = offsets_data[u]; e < offsets_data[u + 1]; ++e) {
+                targets_data[e] = static_cast<int>(packed_data[e] >> 32);
+                weights_data[e] = static_cast<int>(static_cast<uint32_t>(packed_data[e]) ^ 0x80000000u);
+            }
+        }
+
+        return CSRGraph(num_vertices, std::move(offsets), std::move(targets), std::move(weights));
+    }
+
+    // CSR неориентированного графа: каждое ребро списка дает дуги в обоих
+    // направлениях (петля — одну), результат помечен как неориентированный
+    static CSRGraph from_undirected_edges(int num_vertices, const std::vector<Edge>& edges) {
+        const size_t num_edges = edges.size();
+        std::vector<size_t> positions(num_edges + 1, 0);
+        for (size_t i = 0; i < num_edges; ++i) {
+            positions[i + 1] = positions[i] + (edges[i].from == edges[i].to ? 1 : 2);
+        }
+        std::vector<Edge> arcs(positions.back());
+        #pragma omp parallel for
+        for (size_t i = 0; i < num_edges; ++i) {
+            const Edge& edge = edges[i];
+            arcs[positions[i]] = edge;
+            if (edge.from != edge.to) {
+                arcs[positions[i] + 1] = {edge.to, edge.from, edge.weight};
+            }
+        }
+        CSRGraph graph = from_edges(num_vertices, arcs);
+        graph.undirected = true;
+        return graph;
+    }
+
+    // Пометка графа как неориентированного (например, по флагу файла):
+    // вызывающий отвечает за то, что у каждой дуги есть обратная того же веса
+    void mark_undirected(bool value = true) {
+        undirected = value;
+    }
+
+    bool is_undirected() const {
+        return undirected;
+    }
+
+    // У каждой дуги есть обратная того же веса. Граф без флага undirected
+    // сравнивается с транспонированным: строки упорядочены по (to, weight),
+    // поэтому у симметричного графа массивы совпадают
+    bool is_symmetric() const {
+        if (undirected) {
+            return true;
+        }
+        CSRGraph reverse = transpose();
+        return std::equal(offsets_ptr, offsets_ptr + vertices + 1, reverse.offsets())
+            && std::equal(targets_ptr, targets_ptr + edges_count, reverse.targets())
+            && std::equal(weights_ptr, weights_ptr + edges_count, reverse.weights());
+    }
+
+    // Одна копия каждого неориентированного ребра: в строке u остаются
+    // дуги u -> v с v >= u, и ребро {u, v} означает оба направления.
+    // Памяти и чтений ребер за проход вдвое меньше. Граф должен быть
+    // симметричным (is_symmetric), иначе обратные дуги потеряются
+    CSRGraph single_copy() const {
+
+        std::vector<size_t> half_offsets(static_cast<size_t>(vertices) + 1, 0);
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int u = 0; u < vertices; ++u) {
+            // Строка упорядочена по концу: дуги с v >= u лежат в ее хвосте
+            const int* first = std::lower_bound(targets_ptr + offsets_ptr[u], targets_ptr + offsets_ptr[u + 1], u);
+            half_offsets[u + 1] = static_cast<size_t>(targets_ptr + offsets_ptr[u + 1] - first);
+        }
+        for (int u = 0; u < vertices; ++u) {
+            half_offsets[u + 1] += half_offsets[u];
+        }
+
+        std::vector<int> half_targets(half_offsets.back());
+        std::vector<int> half_weights(half_offsets.back());
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int u = 0; u < vertices; ++u) {
+            size_t count = half_offsets[u + 1] - half_offsets[u];
+            size_t begin = offsets_ptr[u + 1] - count;
+            std::copy(targets_ptr + begin, targets_ptr + offsets_ptr[u + 1], half_targets.begin() + half_offsets[u]);
+            std::copy(weights_ptr + begin, weights_ptr + offsets_ptr[u + 1], half_weights.begin() + half_offsets[u]);
+        }
+        return CSRGraph(vertices, std::move(half_offsets), std::move(half_targets), std::move(half_weights));
+    }
+
+    // Разделение ребер на легкие (weight < delta) и тяжелые (weight >= delta)
+    std::pair<CSRGraph, CSRGraph> split_by_weight(int delta) const {
+        std::vector<size_t> light_offsets(static_cast<size_t>(vertices) + 1, 0);
+        std::vector<size_t> heavy_offsets(static_cast<size_t>(vertices) + 1, 0);
+
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int u = 0; u < vertices; ++u) {
+            size_t light = 0;
+            for (size_t e = offsets_ptr[u]; e < offsets_ptr[u + 1]; ++e) {
+                light += weights_ptr[e] < delta;
+            }
+            light_offsets[u + 1] = light;
+            heavy_offsets[u + 1] = (offsets_ptr[u + 1] - offsets_ptr[u]) - light;
+        }
+        for (int u = 0; u < vertices; ++u) {
+            light_offsets[u + 1] += light_offsets[u];
+            heavy_offsets[u + 1] += heavy_offsets[u];
+        }
+
+        std::vector<int> light_targets(light_offsets.back()), light_weights(light_offsets.back());
+        std::vector<int> heavy_targets(heavy_offsets.back()), heavy_weights(heavy_offsets.back());
+
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int u = 0; u < vertices; ++u) {
+            size_t light = light_offsets[u];
+            size_t heavy = heavy_offsets[u];
+            for (size_t e = offsets_ptr[u]; e < offsets_ptr[u + 1]; ++e) {
+                if (weights_ptr[e] < delta) {
+                    light_targets[light] = targets_ptr[e];
+                    light_weights[light++] = weights_ptr[e];
+                } else {
+                    heavy_targets[heavy] = targets_ptr[e];
+                    heavy_weights[heavy++] = weights_ptr[e];
+                }
+            }
+        }
+
+        return {
+            CSRGraph(vertices, std::move(light_offsets), std::move(light_targets), std::move(light_weights)),
+            CSRGraph(vertices, std::move(heavy_offsets), std::move(heavy_targets), std::move(heavy_weights))
+        };
+    }
+
+    // Транспонированный граф: строка v содержит входящие ребра вершины v,
+    // targets хранит их начала. Строки упорядочены по номеру начала,
+    // поэтому результат не зависит от числа потоков.
+    CSRGraph transpose() const {
+        std::vector<size_t> in_offsets(static_cast<size_t>(vertices) + 1, 0);
+        size_t* in_offsets_data = in_offsets.data();
+        #pragma omp parallel for
+        for (size_t e = 0; e < edges_count; ++e) {
+            #pragma omp atomic
+            in_offsets_data[targets_ptr[e] + 1]++;
+        }
+        for (int v = 0; v < vertices; ++v) {
+            in_offsets[v + 1] += in_offsets[v];
+        }
+
+        // Начало и вес ребра упакованы в один ключ, как в from_edges
+        std::vector<size_t> cursor(in_offsets.begin(), in_offsets.end() - 1);
+        std::vector<uint64_t> packed(edges_count);
+        size_t* cursor_data = cursor.data();
+        uint64_t* packed_data = packed.data();
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int u = 0; u < vertices; ++u) {
+            for (size_t e = offsets_ptr[u]; e < offsets_ptr[u + 1]; ++e) {
+                size_t position;
+                #pragma omp atomic capture
+                position = cursor_data[targets_ptr[e]]++;
+                packed_data[position] = (static_cast<uint64_t>(u) << 32)
+                    | (static_cast<uint32_t>(weights_ptr[e]) ^ 0x80000000u);
+            }
+        }
+
+        std::vector<int> sources(edges_count);
+        std::vector<int> in_weights(edges_count);
+        int* sources_data = sources.data();
+        int* in_weights_data = in_weights.data();
+        #pragma omp parallel for schedule(dynamic, 1024)
+        for (int v = 0; v < vertices; ++v) {
+            std::sort(packed_data + in_offsets_data[v], packed_data + in_offsets_data[v + 1]);
+            for (size_t e = in_offsets_data[v]; e < in_offsets_data[v + 1]; ++e) {
+                sources_data[e] = static_cast<int>(packed_data[e] >> 32);
+                in_weights_data[e] = static_cast<int>(static_cast<uint32_t>(packed_data[e]) ^ 0x80000000u);
+            }
+        }
+
+        return CSRGraph(vertices, std::move(in_offsets), std::move(sources), std::move(in_weights));
+    }
+
+    // Получение количества вершин
+    int get_vertices() const {
+        return vertices;
+    }
+
+    // Получение количества ребер
+    size_t get_edges_count() const {
+        return edges_count;
+    }
+
+    // Степень вершины
+    size_t degree(int u) const {
+        return offsets_ptr[u + 1] - offsets_ptr[u];
+    }
+
+    // Смещения строк, vertices + 1 элементов
+    const size_t* offsets() const {
+        return offsets_ptr;
+    }
+
+    // Концы ребер, edges_count элементов
+    const int* targets() const {
+        return targets_ptr;
+    }
+
+    // Веса ребер, edges_count элементов
+    const int* weights() const {
+        return weights_ptr;
+    }
+};
+
+// Список ребер. Ребро неориентированного графа (по умолчанию) хранится
+// один раз и в CSR дает дуги в обоих направлениях; ребро
+// ориентированного — одну дугу from -> to.
 class Graph {
 private:
     std::vector<Edge> edges;
     int vertices;
+    bool directed;
 
 public:
     // Конструктор
-    Graph(int num_vertices = 0) : vertices(num_vertices) {}
+    Graph(int num_vertices = 0, bool is_directed = false) : vertices(num_vertices), directed(is_directed) {}
+
+    // Граф из готового списка ребер (например, от генератора)
+    Graph(int num_vertices, std::vector<Edge> graph_edges, bool is_directed = false)
+        : edges(std::move(graph_edges)), vertices(num_vertices), directed(is_directed) {}
 
     // Добавление ребра
     void add_edge(int from, int to, int weight = 1) {
@@ -25,44 +340,24 @@ public:
             throw std::out_of_range("Vertex index out of range");
         }
         edges.push_back({from, to, weight});
-        edges.push_back({to, from, weight});
-    }
-
-    // Создание случайного графа
-    void create_random_graph(int num_vertices, double edge_probability) {
-        vertices = num_vertices;
-        edges.clear();
-
-        std::random_device rd;
-        std::mt19937 gen(rd());
-        std::uniform_real_distribution<> dis(0.0, 1.0);
-        std::uniform_int_distribution<> weight_dis(1, 100);
-
-        for (int i = 0; i < num_vertices; ++i) {
-            for (int j = i + 1; j < num_vertices; ++j) {
-                if (dis(gen) < edge_probability) {
-                    int weight = weight_dis(gen);
-                    edges.push_back({i, j, weight});
-                    edges.push_back({j, i, weight});
-                }
-            }
-        }
     }
 
-    // Запись графа в файл
+    // Запись графа в файл: первая строка — число вершин и directed или
+    // undirected, затем ребра "from to weight" по одному разу
     void save_to_file(const std::string& filename) const {
         std::ofstream file(filename);
         if (!file.is_open()) {
             throw std::runtime_error("Cannot open file for writing");
         }
 
-        file << vertices << "\n";
+        file << vertices << (directed ? " directed" : " undirected") << "\n";
         for (const auto& edge : edges) {
             file << edge.from << " " << edge.to << " " << edge.weight << "\n";
         }
     }
 
-    // Загрузка графа из файла
+    // Загрузка графа из файла. Файл без слова directed или undirected
+    // (старый формат с ребрами в обоих направлениях) читается как ориентированный
     void load_from_file(const std::string& filename) {
         std::ifstream file(filename);
         if (!file.is_open()) {
@@ -70,6 +365,14 @@ public:
         }
 
         file >> vertices;
+        std::string kind;
+        std::getline(file, kind);
+        kind.erase(0, kind.find_first_not_of(" \t"));
+        kind.erase(kind.find_last_not_of(" \t\r") + 1);
+        if (kind != "" && kind != "directed" && kind != "undirected") {
+            throw std::runtime_error("Unknown graph kind: " + kind);
+        }
+        directed = kind != "undirected";
         edges.clear();
 
         int from, to, weight;
@@ -83,21 +386,19 @@ public:
         return vertices;
     }
 
+    bool is_directed() const {
+        return directed;
+    }
+
     // Получение всех ребер
     const std::vector<Edge>& get_edges() const {
         return edges;
     }
 
-    // Преобразование графа в матрицу смежности
-    std::vector<std::vector<std::pair<int, int>>> to_adjacency_matrix() const {
-        std::vector<std::vector<std::pair<int, int>>> adj_matrix(vertices);
-
-        for (const auto& edge : edges) {
-            adj_matrix[edge.from].emplace_back(edge.to, edge.weight);
-        }
-
-        return adj_matrix;
+    // Преобразование графа в формат CSR
+    CSRGraph to_csr() const {
+        return directed ? CSRGraph::from_edges(vertices, edges) : CSRGraph::from_undirected_edges(vertices, edges);
     }
 };
 
-const int INF = std::numeric_limits<int>::max() / 2;
\ No newline at end of file
+const int INF = std::numeric_limits<int>::max() / 2;
@@ -0,0 +1,386 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "graph.hpp"
+#include "binary_graph.hpp"
+#include "mapped_file.hpp"
+
+// Параллельная загрузка графов из текстовых форматов.
+// Файл отображается в память и режется на куски по границам строк,
+// куски разбираются всеми потоками через std::from_chars, а найденные ребра
+// сливаются в один список и превращаются в CSR.
+//
+// Поддерживаемые форматы:
+//   native — формат проекта: число вершин и directed или undirected (без
+//            слова — ориентированный), затем строки "from to weight";
+//            ребро неориентированного графа записано один раз
+//   dimacs — DIMACS .gr: "p sp n m", дуги "a u v w" (нумерация с 1)
+//   mtx    — Matrix Market coordinate (нумерация с 1, symmetric — неориентированный)
+//   snap   — SNAP edge list: "u v [weight]", комментарии '#', вершин max id + 1
+//   binary — бинарный формат из binary_graph.hpp
+namespace graph_loaders {
+
+enum class Format { Auto, Native, Dimacs, MatrixMarket, Snap, Binary };
+
+const size_t MIN_CHUNK_SIZE = 1 << 20;
+
+inline Format parse_format(const std::string& name) {
+    if (name == "auto") return Format::Auto;
+    if (name == "native") return Format::Native;
+    if (name == "dimacs") return Format::Dimacs;
+    if (name == "mtx") return Format::MatrixMarket;
+    if (name == "snap") return Format::Snap;
+    if (name == "binary") return Format::Binary;
+    throw std::invalid_argument("Unknown graph format: " + name);
+}
+
+inline bool ends_with(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+inline bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Чтение целого числа с пропуском пробелов; p сдвигается за число
+inline bool parse_integer(const char*& p, const char* end, long long& value) {
+    while (p < end && is_space(*p)) ++p;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    p = result.ptr;
+    return true;
+}
+
+inline bool parse_real(const char*& p, const char* end, double& value) {
+    while (p < end && is_space(*p)) ++p;
+    auto result = std::from_chars(p, end, value);
+    if (result.ec != std::errc()) {
+        return false;
+    }
+    p = result.ptr;
+    return true;
+}
+
+inline bool only_spaces(const char* p, const char* end) {
+    while (p < end && is_space(*p)) ++p;
+    return p == end;
+}
+
+// Необязательное слово directed или undirected до конца строки заголовка.
+// Возвращает false, если в строке что-то другое
+inline bool parse_graph_kind(const char* p, const char* end, bool& undirected) {
+    while (p < end && is_space(*p)) ++p;
+    const char* word = p;
+    while (p < end && !is_space(*p)) ++p;
+    std::string kind(word, p);
+    if (!only_spaces(p, end) || (kind != "" && kind != "directed" && kind != "undirected")) {
+        return false;
+    }
+    undirected = kind == "undirected";
+    return true;
+}
+
+inline const char* line_end(const char* p, const char* end) {
+    const char* newline = static_cast<const char*>(std::memchr(p, '\n', end - p));
+    return newline ? newline : end;
+}
+
+inline std::string line_text(const char* p, const char* end) {
+    return std::string(p, std::min(line_end(p, end), p + 80));
+}
+
+// Описание тела файла, которое разбирается параллельно
+struct Layout {
+    const char* body = nullptr;   // начало первой строки с ребрами
+    long long vertices = -1;      // -1, если число вершин определяется по ребрам
+    bool one_based = false;
+    bool symmetric = false;       // неориентированный: Matrix Market symmetric или native undirected
+    bool pattern = false;         // Matrix Market pattern: весов нет, вес 1
+};
+
+// Разбор одной строки тела файла. Возвращает false при ошибке формата
+inline bool parse_line(Format format, const Layout& layout, const char* p, const char* end,
+                       std::vector<Edge>& edges, long long& max_vertex) {
+    while (p < end && is_space(*p)) ++p;
+    if (p == end) {
+        return true;
+    }
+
+    if (format == Format::Dimacs) {
+        if (*p == 'c' || *p == 'p') return true;
+        if (*p != 'a') return false;
+        ++p;
+    } else if (format == Format::MatrixMarket) {
+        if (*p == '%') return true;
+    } else if (format == Format::Snap) {
+        if (*p == '#' || *p == '%') return true;
+    }
+
+    long long from, to, weight = 1;
+    if (!parse_integer(p, end, from) || !parse_integer(p, end, to)) {
+        return false;
+    }
+    if (format == Format::MatrixMarket && !layout.pattern) {
+        double value;
+        if (!parse_real(p, end, value) || !std::isfinite(value)) {
+            return false;
+        }
+        weight = static_cast<long long>(std::llround(value));
+    } else if (format == Format::Snap) {
+        if (!only_spaces(p, end) && !parse_integer(p, end, weight)) {
+            return false;
+        }
+    } else if (format != Format::MatrixMarket) {
+        if (!parse_integer(p, end, weight)) {
+            return false;
+        }
+    }
+    if (!only_spaces(p, end)) {
+        return false;
+    }
+
+    if (layout.one_based) {
+        --from;
+        --to;
+    }
+    if (from < 0 || to < 0 || from >= std::numeric_limits<int>::max() || to >= std::numeric_limits<int>::max()
+        || weight < std::numeric_limits<int>::min() || weight > std::numeric_limits<int>::max()) {
+        return false;
+    }
+
+    // Обратные дуги неориентированного графа добавляет CSRGraph::from_undirected_edges
+    edges.push_back({static_cast<int>(from), static_cast<int>(to), static_cast<int>(weight)});
+    max_vertex = std::max(max_vertex, std::max(from, to));
+    return true;
+}
+
+// Последовательный разбор заголовка: все, что идет до ребер
+inline Layout read_header(Format format, const char* data, const char* end) {
+    Layout layout;
+    const char* p = data;
+
+    auto next_line = [&](const char* line) {
+        const char* stop = line_end(line, end);
+        return stop == end ? end : stop + 1;
+    };
+
+    if (format == Format::Native) {
+        long long vertices;
+        if (!parse_integer(p, end, vertices) || vertices < 0) {
+            throw std::runtime_error("Native graph file must start with the number of vertices");
+        }
+        layout.vertices = vertices;
+        const char* stop = line_end(p, end);
+        if (!parse_graph_kind(p, stop, layout.symmetric)) {
+            throw std::runtime_error("Native graph header must be the number of vertices and directed or undirected: " + line_text(data, end));
+        }
+        layout.body = stop;
+    } else if (format == Format::Dimacs) {
+        layout.one_based = true;
+        for (const char* line = p; line < end; line = next_line(line)) {
+            const char* stop = line_end(line, end);
+            const char* q = line;
+            while (q < stop && is_space(*q)) ++q;
+            if (q < stop && *q == 'p') {
+                q++;
+                while (q < stop && is_space(*q)) ++q;
+                while (q < stop && !is_space(*q)) ++q; // тип задачи, обычно "sp"
+                long long vertices, arcs;
+                if (!parse_integer(q, stop, vertices) || !parse_integer(q, stop, arcs)) {
+                    throw std::runtime_error("Malformed DIMACS problem line: " + line_text(line, end));
+                }
+                layout.vertices = vertices;
+                layout.body = next_line(line);
+                break;
+            }
+            if (q < stop && *q == 'a') {
+                break;
+            }
+        }
+        if (layout.vertices < 0) {
+            throw std::runtime_error("DIMACS file has no problem line");
+        }
+    } else if (format == Format::MatrixMarket) {
+        layout.one_based = true;
+        const char* stop = line_end(p, end);
+        std::string banner(p, stop);
+        for (auto& c : banner) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (banner.rfind("%%matrixmarket", 0) != 0 || banner.find("coordinate") == std::string::npos) {
+            throw std::runtime_error("Only coordinate Matrix Market files are supported");
+        }
+        if (banner.find("complex") != std::string::npos || banner.find("skew-symmetric") != std::string::npos
+            || banner.find("hermitian") != std::string::npos) {
+            throw std::runtime_error("Unsupported Matrix Market field or symmetry: " + banner);
+        }
+        layout.pattern = banner.find("pattern") != std::string::npos;
+        layout.symmetric = banner.find("symmetric") != std::string::npos;
+
+        for (const char* line = next_line(p); line < end; line = next_line(line)) {
+            const char* q = line;
+            stop = line_end(line, end);
+            if (only_spaces(q, stop) || *q == '%') {
+                continue;
+            }
+            long long rows, cols, entries;
+            if (!parse_integer(q, stop, rows) || !parse_integer(q, stop, cols) || !parse_integer(q, stop, entries)) {
+                throw std::runtime_error("Malformed Matrix Market size line: " + line_text(line, end));
+            }
+            if (rows != cols) {
+                throw std::runtime_error("Matrix Market adjacency matrix must be square");
+            }
+            layout.vertices = rows;
+            layout.body = next_line(line);
+            break;
+        }
+        if (layout.vertices < 0) {
+            throw std::runtime_error("Matrix Market file has no size line");
+        }
+    } else {
+        layout.body = p;
+    }
+
+    if (layout.vertices > std::numeric_limits<int>::max()) {
+        throw std::runtime_error("Too many vertices");
+    }
+    return layout;
+}
+
+// Определение формата по расширению и первым байтам файла
+inline Format detect_format(const std::string& filename, const char* data, const char* end) {
+    if (end - data >= static_cast<long>(sizeof(binary_graph::MAGIC))
+        && std::memcmp(data, binary_graph::MAGIC, sizeof(binary_graph::MAGIC)) == 0) {
+        return Format::Binary;
+    }
+    if (ends_with(filename, ".gr")) return Format::Dimacs;
+    if (ends_with(filename, ".mtx")) return Format::MatrixMarket;
+    if (end - data >= 14 && std::memcmp(data, "%%MatrixMarket", 14) == 0) return Format::MatrixMarket;
+
+    // Первая значимая строка: одно число (и directed или undirected) — native,
+    // '#' или пара чисел — SNAP,
+    // 'c'/'p' — DIMACS
+    const char* p = data;
+    while (p < end && (is_space(*p) || *p == '\n')) ++p;
+    if (p < end && *p == '#') return Format::Snap;
+    if (p < end && (*p == 'c' || *p == 'p')) return Format::Dimacs;
+    long long value;
+    const char* stop = line_end(p, end);
+    bool undirected;
+    if (parse_integer(p, stop, value) && parse_graph_kind(p, stop, undirected)) return Format::Native;
+    return Format::Snap;
+}
+
+// Параллельный разбор тела файла в список ребер
+inline std::vector<Edge> parse_body(Format format, const Layout& layout, const char* end, long long& max_vertex) {
+    const char* body = layout.body;
+    size_t size = static_cast<size_t>(end - body);
+
+    int threads = 1;
+    #ifdef _OPENMP
+    threads = omp_get_max_threads();
+    #endif
+    size_t chunks = std::max<size_t>(1, std::min<size_t>(size / MIN_CHUNK_SIZE, static_cast<size_t>(threads) * 8));
+
+    // Начало каждого куска сдвигается на начало следующей строки,
+    // поэтому каждая строка разбирается ровно одним куском
+    std::vector<const char*> starts(chunks + 1, end);
+    starts[0] = body;
+    for (size_t c = 1; c < chunks; ++c) {
+        const char* guess = body + size / chunks * c;
+        const char* stop = line_end(guess, end);
+        starts[c] = stop == end ? end : stop + 1;
+    }
+    for (size_t c = chunks - 1; c > 0; --c) {
+        starts[c] = std::min(starts[c], starts[c + 1]);
+    }
+
+    std::vector<std::vector<Edge>> chunk_edges(chunks);
+    std::vector<long long> chunk_max(chunks, -1);
+    std::vector<const char*> chunk_error(chunks, nullptr);
+
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t c = 0; c < chunks; ++c) {
+        std::vector<Edge>& edges = chunk_edges[c];
+        edges.reserve(static_cast<size_t>(starts[c + 1] - starts[c]) / 8);
+        for (const char* line = starts[c]; line < starts[c + 1];) {
+            const char* stop = line_end(line, end);
+            if (!parse_line(format, layout, line, stop, edges, chunk_max[c])) {
+                chunk_error[c] = line;
+                break;
+            }
+            line = stop + 1;
+        }
+    }
+
+    for (size_t c = 0; c < chunks; ++c) {
+        if (chunk_error[c]) {
+            throw std::runtime_error("Malformed graph line: " + line_text(chunk_error[c], end));
+        }
+    }
+
+    // Слияние кусков: смещения по префиксной сумме, копирование параллельно
+    std::vector<size_t> positions(chunks + 1, 0);
+    for (size_t c = 0; c < chunks; ++c) {
+        positions[c + 1] = positions[c] + chunk_edges[c].size();
+        max_vertex = std::max(max_vertex, chunk_max[c]);
+    }
+    std::vector<Edge> edges(positions[chunks]);
+    #pragma omp parallel for schedule(dynamic, 1)
+    for (size_t c = 0; c < chunks; ++c) {
+        std::copy(chunk_edges[c].begin(), chunk_edges[c].end(), edges.begin() + positions[c]);
+        std::vector<Edge>().swap(chunk_edges[c]);
+    }
+    return edges;
+}
+
+// Загрузка графа в любом поддерживаемом формате; prefetch — заранее
+// подкачать бинарный файл целиком (текстовые форматы читаются всегда целиком),
+// verify — сверить контрольную сумму бинарного файла
+inline CSRGraph load_graph(const std::string& filename, Format format = Format::Auto, bool prefetch = true,
+                           bool verify = false) {
+    if (format == Format::Binary) {
+        return binary_graph::load(filename, verify, prefetch);
+    }
+
+    MappedFile file(filename);
+    const char* data = reinterpret_cast<const char*>(file.get_data());
+    const char* end = data + file.get_size();
+    file.advise(0, file.get_size(), MADV_SEQUENTIAL);
+
+    if (format == Format::Auto) {
+        format = detect_format(filename, data, end);
+        if (format == Format::Binary) {
+            return binary_graph::load(filename, verify, prefetch);
+        }
+    }
+
+    Layout layout = read_header(format, data, end);
+    long long max_vertex = -1;
+    std::vector<Edge> edges = parse_body(format, layout, end, max_vertex);
+
+    long long vertices = layout.vertices >= 0 ? layout.vertices : max_vertex + 1;
+    if (max_vertex >= vertices) {
+        throw std::runtime_error("Vertex index out of range");
+    }
+    if (vertices > std::numeric_limits<int>::max()) {
+        throw std::runtime_error("Too many vertices");
+    }
+    if (layout.symmetric) {
+        return CSRGraph::from_undirected_edges(static_cast<int>(vertices), edges);
+    }
+    return CSRGraph::from_edges(static_cast<int>(vertices), edges);
+}
+
+}
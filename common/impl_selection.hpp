@@ -0,0 +1,43 @@
+#pragma once
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Выбор реализаций по ключам из опции --impl: список через запятую или all.
+// Без опции запускается первая зарегистрированная реализация.
+template <typename Impl>
+bool select_impls(std::vector<Impl>& impls, const std::string& keys) {
+    if (keys == "all") {
+        return true;
+    }
+    if (keys.empty()) {
+        impls.resize(std::min<size_t>(impls.size(), 1));
+        return true;
+    }
+
+    std::vector<Impl> selected;
+    size_t start = 0;
+    while (start <= keys.size()) {
+        size_t comma = std::min(keys.find(',', start), keys.size());
+        std::string key = keys.substr(start, comma - start);
+        bool found = false;
+        for (const auto& impl : impls) {
+            if (impl.key == key) {
+                selected.push_back(impl);
+                found = true;
+            }
+        }
+        if (!found) {
+            std::cerr << "Ошибка: неизвестная реализация " << key << ", доступны:";
+            for (const auto& impl : impls) {
+                std::cerr << " " << impl.key;
+            }
+            std::cerr << std::endl;
+            return false;
+        }
+        start = comma + 1;
+    }
+    impls = selected;
+    return true;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Отображение файла в память только для чтения
+class MappedFile {
+private:
+    void* data = MAP_FAILED;
+    size_t size = 0;
+
+public:
+    explicit MappedFile(const std::string& filename) {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd < 0) {
+            throw std::runtime_error("Cannot open file for reading");
+        }
+        struct stat st;
+        if (fstat(fd, &st) != 0) {
+            close(fd);
+            throw std::runtime_error("Cannot stat file");
+        }
+        size = static_cast<size_t>(st.st_size);
+        if (size > 0) {
+            data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        }
+        close(fd);
+        if (size > 0 && data == MAP_FAILED) {
+            throw std::runtime_error("Cannot map file into memory");
+        }
+    }
+
+    ~MappedFile() {
+        if (data != MAP_FAILED) {
+            munmap(data, size);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const unsigned char* get_data() const {
+        return data == MAP_FAILED ? nullptr : static_cast<const unsigned char*>(data);
+    }
+
+    size_t get_size() const {
+        return size;
+    }
+
+    // Подсказка ядру о характере доступа к диапазону файла
+    void advise(size_t offset, size_t length, int advice) const {
+        if (data == MAP_FAILED || length == 0) {
+            return;
+        }
+        size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        size_t begin = offset / page * page;
+        madvise(static_cast<char*>(data) + begin, std::min(size, offset + length) - begin, advice);
+    }
+};
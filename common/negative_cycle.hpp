@@ -0,0 +1,93 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+
+// Отрицательный цикл, достижимый из источника: расстояния не определены,
+// поэтому движок вместо них бросает исключение со свидетелем — вершинами
+// цикла в порядке ребер (cycle[i] -> cycle[i + 1], последняя -> первая).
+class NegativeCycleError : public std::runtime_error {
+public:
+    std::vector<int> cycle;
+
+    explicit NegativeCycleError(std::vector<int> cycle)
+        : std::runtime_error("Negative cycle of " + std::to_string(cycle.size()) + " vertices is reachable from the source"),
+          cycle(std::move(cycle)) {}
+};
+
+// Поиск цикла в графе предков, начиная с вершин starts. Каждая вершина
+// проходится не больше одного раза за вызов: stamp[v] — номер вызова, в
+// котором v уже пройдена, owner[v] — номер прохода в starts (вершины в
+// starts могут повторяться).
+// Цикл в графе предков, построенном строгими уменьшениями расстояний,
+// всегда отрицательный. Возвращает вершины цикла в порядке ребер или
+// пустой вектор
+class ParentCycleFinder {
+    std::vector<int> stamp;
+    std::vector<int> owner;
+    int current = 0;
+
+public:
+    explicit ParentCycleFinder(int vertices) : stamp(vertices, 0), owner(vertices, -1) {}
+
+    template <typename ParentOf>
+    std::vector<int> find(const std::vector<int>& starts, ParentOf parent_of) {
+        if (++current == 0) {
+            std::fill(stamp.begin(), stamp.end(), 0);
+            current = 1;
+        }
+        for (size_t walk = 0; walk < starts.size(); ++walk) {
+            int v = starts[walk];
+            while (v != -1 && stamp[v] != current) {
+                stamp[v] = current;
+                owner[v] = static_cast<int>(walk);
+                v = parent_of(v);
+            }
+            if (v != -1 && owner[v] == static_cast<int>(walk)) {
+                // v лежит на цикле: обход по предкам возвращает цикл в обратном порядке
+                std::vector<int> cycle{v};
+                for (int u = parent_of(v); u != v; u = parent_of(u)) {
+                    cycle.push_back(u);
+                }
+                std::reverse(cycle.begin(), cycle.end());
+                return cycle;
+            }
+        }
+        return {};
+    }
+};
+
+// Вес цикла по самым легким ребрам между соседними вершинами;
+// false, если какого-то ребра нет или вес неотрицателен
+inline bool check_negative_cycle(const CSRGraph& graph, const std::vector<int>& cycle, long long& weight) {
+    const size_t* offsets = graph.offsets();
+    const int* targets = graph.targets();
+    const int* weights = graph.weights();
+    weight = 0;
+    if (cycle.empty()) {
+        return false;
+    }
+    for (size_t i = 0; i < cycle.size(); ++i) {
+        int u = cycle[i];
+        int v = cycle[(i + 1) % cycle.size()];
+        if (u < 0 || u >= graph.get_vertices()) {
+            return false;
+        }
+        bool found = false;
+        int lightest = 0;
+        for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            if (targets[e] == v && (!found || weights[e] < lightest)) {
+                lightest = weights[e];
+                found = true;
+            }
+        }
+        if (!found) {
+            return false;
+        }
+        weight += lightest;
+    }
+    return weight < 0;
+}
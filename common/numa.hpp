@@ -0,0 +1,233 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+// Размещение данных по узлам NUMA без libnuma: топология из sysfs,
+// привязка потоков через sched_setaffinity, размещение страниц первой
+// записью (first touch) и проверка узла страниц через move_pages.
+// Вне Linux все сводится к одному узлу, а узлы страниц неизвестны.
+namespace numa {
+
+// Разбор списка процессоров вида "0-3,8,10-11"
+inline std::vector<int> parse_cpu_list(const std::string& text) {
+    std::vector<int> cpus;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (item.empty() || item == "\n") {
+            continue;
+        }
+        size_t dash = item.find('-');
+        int first = std::stoi(item.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(item.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+// Узлы с процессорами. Потоки делятся между узлами непрерывными
+// блоками: поток t из T работает на узле t * nodes / T, поэтому
+// соседние диапазоны вершин попадают на один узел
+class Topology {
+    std::vector<std::vector<int>> node_cpus;
+    std::vector<int> node_ids; // номера узлов в системе
+
+public:
+    static Topology detect() {
+        Topology topology;
+        #ifdef __linux__
+        for (int node = 0;; ++node) {
+            std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!file.is_open()) {
+                break;
+            }
+            std::string line;
+            std::getline(file, line);
+            std::vector<int> cpus = parse_cpu_list(line);
+            // Узлы только с памятью потоки не получают
+            if (!cpus.empty()) {
+                topology.node_cpus.push_back(cpus);
+                topology.node_ids.push_back(node);
+            }
+        }
+        #endif
+        if (topology.node_cpus.empty()) {
+            std::vector<int> cpus(std::max(1u, std::thread::hardware_concurrency()));
+            for (size_t i = 0; i < cpus.size(); ++i) {
+                cpus[i] = static_cast<int>(i);
+            }
+            topology.node_cpus.push_back(cpus);
+            topology.node_ids.push_back(0);
+        }
+        return topology;
+    }
+
+    int nodes() const {
+        return static_cast<int>(node_cpus.size());
+    }
+
+    // Порядковый номер узла потока, от 0 до nodes() - 1
+    int node_of_thread(int thread, int threads) const {
+        return static_cast<int>(static_cast<long long>(thread) * nodes() / threads);
+    }
+
+    // Номер узла в системе, как его возвращает page_nodes
+    int node_id(int node) const {
+        return node_ids[node];
+    }
+
+    int cpu_of_thread(int thread, int threads) const {
+        int node = node_of_thread(thread, threads);
+        // Первый поток узла — наименьший t с t * nodes / threads >= node
+        int first = static_cast<int>((static_cast<long long>(node) * threads + nodes() - 1) / nodes());
+        const std::vector<int>& cpus = node_cpus[node];
+        return cpus[(thread - first) % cpus.size()];
+    }
+};
+
+// Привязка вызывающего потока к одному процессору на время жизни
+// объекта; прежняя маска восстанавливается в деструкторе
+class ThreadPin {
+    #ifdef __linux__
+    cpu_set_t previous;
+    #endif
+    bool pinned = false;
+
+public:
+    explicit ThreadPin(int cpu) {
+        #ifdef __linux__
+        if (sched_getaffinity(0, sizeof(previous), &previous) == 0) {
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            CPU_SET(cpu, &mask);
+            pinned = sched_setaffinity(0, sizeof(mask), &mask) == 0;
+        }
+        #else
+        (void)cpu;
+        #endif
+    }
+
+    ~ThreadPin() {
+        #ifdef __linux__
+        if (pinned) {
+            sched_setaffinity(0, sizeof(previous), &previous);
+        }
+        #endif
+    }
+
+    ThreadPin(const ThreadPin&) = delete;
+    ThreadPin& operator=(const ThreadPin&) = delete;
+};
+
+inline size_t page_size() {
+    #ifdef __linux__
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    #else
+    return 4096;
+    #endif
+}
+
+// Массив без инициализации при выделении: страница получает физическую
+// память на узле потока, который первым пишет в нее
+template <typename T>
+class Buffer {
+    T* ptr = nullptr;
+    size_t count = 0;
+
+public:
+    Buffer() = default;
+
+    explicit Buffer(size_t count) : count(count) {
+        size_t page = page_size();
+        size_t bytes = (std::max<size_t>(count * sizeof(T), 1) + page - 1) / page * page;
+        ptr = static_cast<T*>(std::aligned_alloc(page, bytes));
+        if (!ptr) {
+            throw std::bad_alloc();
+        }
+    }
+
+    ~Buffer() {
+        std::free(ptr);
+    }
+
+    Buffer(Buffer&& other) noexcept : ptr(other.ptr), count(other.count) {
+        other.ptr = nullptr;
+        other.count = 0;
+    }
+
+    Buffer& operator=(Buffer&& other) noexcept {
+        std::swap(ptr, other.ptr);
+        std::swap(count, other.count);
+        return *this;
+    }
+
+    T* data() {
+        return ptr;
+    }
+
+    const T* data() const {
+        return ptr;
+    }
+
+    size_t size() const {
+        return count;
+    }
+};
+
+// Узел каждой страницы диапазона [address, address + bytes), начиная
+// со страницы, содержащей address; -1 — узел неизвестен
+inline std::vector<int> page_nodes(const void* address, size_t bytes) {
+    size_t page = page_size();
+    uintptr_t first = reinterpret_cast<uintptr_t>(address) / page * page;
+    uintptr_t last = reinterpret_cast<uintptr_t>(address) + bytes;
+    size_t count = bytes == 0 ? 0 : (last - first + page - 1) / page;
+    std::vector<int> nodes(count, -1);
+    #if defined(__linux__) && defined(SYS_move_pages)
+    std::vector<void*> pages(count);
+    for (size_t i = 0; i < count; ++i) {
+        pages[i] = reinterpret_cast<void*>(first + i * page);
+    }
+    // Пустой список узлов — только запрос текущего размещения
+    if (count > 0 && syscall(SYS_move_pages, 0, count, pages.data(), nullptr, nodes.data(), 0) != 0) {
+        std::fill(nodes.begin(), nodes.end(), -1);
+    }
+    for (int& node : nodes) {
+        node = std::max(node, -1);
+    }
+    #endif
+    return nodes;
+}
+
+// Число чтений за раунд на своем и чужом узле
+struct Locality {
+    long long local = 0;
+    long long remote = 0;
+    long long unknown = 0;
+
+    void add(int page_node, int thread_node) {
+        if (page_node < 0) {
+            ++unknown;
+        } else if (page_node == thread_node) {
+            ++local;
+        } else {
+            ++remote;
+        }
+    }
+};
+
+} // namespace numa
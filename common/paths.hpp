@@ -0,0 +1,197 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "graph.hpp"
+#include "engine.hpp"
+#include "atomics.hpp"
+
+// Дерево кратчайших путей. Параллельные движки хранят у вершины одну
+// метку: без предков — расстояние (int), с предками — упакованное в
+// 64 бита расстояние (старшие 32 бита, со знаком) и предок (младшие 32).
+// Метка обновляется одним сравнением с обменом, как расстояние без
+// предков, поэтому предок всегда соответствует расстоянию, а число
+// атомарных операций не растет.
+using PackedLabel = int64_t;
+
+inline PackedLabel pack_label(int dist, int parent) {
+    return static_cast<PackedLabel>((static_cast<uint64_t>(static_cast<int64_t>(dist)) << 32) | static_cast<uint32_t>(parent));
+}
+
+inline int label_distance(int label) {
+    return label;
+}
+
+inline int label_distance(PackedLabel label) {
+    return static_cast<int>(label >> 32);
+}
+
+inline int label_parent(PackedLabel label) {
+    return static_cast<int>(static_cast<uint32_t>(label));
+}
+
+template <typename Label>
+inline Label make_label(int dist, int parent);
+
+template <>
+inline int make_label<int>(int dist, int) {
+    return dist;
+}
+
+template <>
+inline PackedLabel make_label<PackedLabel>(int dist, int parent) {
+    return pack_label(dist, parent);
+}
+
+// Атомарное уменьшение метки: true, если расстояние строго уменьшилось.
+// Упакованные метки сравниваются только по расстоянию: при равных
+// расстояниях предок не меняется, поэтому ребра нулевого веса не
+// замыкают предков в цикл
+inline bool atomic_relax(int* address, int label) {
+    return atomic_min(address, label);
+}
+
+inline bool atomic_relax(PackedLabel* address, PackedLabel label) {
+    PackedLabel old = __atomic_load_n(address, __ATOMIC_RELAXED);
+    while (label_distance(label) < label_distance(old)) {
+        if (__atomic_compare_exchange_n(address, &old, label, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Распаковка меток в расстояния и предков
+inline void unpack_labels(const PackedLabel* labels, int vertices, std::vector<int>& dist, std::vector<int>& parents) {
+    dist.resize(vertices);
+    parents.resize(vertices);
+    #pragma omp parallel for
+    for (int v = 0; v < vertices; ++v) {
+        dist[v] = label_distance(labels[v]);
+        parents[v] = label_parent(labels[v]);
+    }
+}
+
+// Путь от source до target по предкам в path; false и пустой path, если
+// target недостижима. Стоимость пропорциональна длине пути
+inline bool extract_path(const std::vector<int>& parents, int source, int target, std::vector<int>& path) {
+    path.clear();
+    if (target < 0 || target >= static_cast<int>(parents.size())) {
+        throw std::out_of_range("Target vertex is out of range");
+    }
+    for (int v = target; v != -1; v = parents[v]) {
+        if (path.size() >= parents.size()) {
+            throw std::runtime_error("Parent pointers contain a cycle");
+        }
+        path.push_back(v);
+    }
+    if (path.back() != source) {
+        path.clear();
+        return false;
+    }
+    std::reverse(path.begin(), path.end());
+    return true;
+}
+
+// Проверка дерева: у источника и недостижимых вершин предка нет, у
+// остальных есть ребро parent -> v с dist[parent] + w == dist[v], и
+// по предкам каждая вершина доходит до источника. Возвращает число
+// вершин с ошибкой
+inline int check_tree(const CSRGraph& graph, const std::vector<int>& dist, const std::vector<int>& parents, int source) {
+    int vertices = graph.get_vertices();
+    const size_t* offsets = graph.offsets();
+    const int* targets = graph.targets();
+    const int* weights = graph.weights();
+    int errors = 0;
+    // 0 — не проверена, 1 — на текущем пути, 2 — доходит до источника
+    std::vector<char> state(vertices, 0);
+    state[source] = 2;
+    errors += parents[source] != -1;
+    std::vector<int> chain;
+    for (int v = 0; v < vertices; ++v) {
+        if (v == source) {
+            continue;
+        }
+        int p = parents[v];
+        if (dist[v] >= INF) {
+            errors += p != -1;
+            state[v] = 2;
+            continue;
+        }
+        bool found = false;
+        if (p >= 0 && p < vertices && dist[p] < INF) {
+            for (size_t e = offsets[p]; e < offsets[p + 1] && !found; ++e) {
+                found = targets[e] == v && dist[p] + weights[e] == dist[v];
+            }
+        }
+        errors += !found;
+    }
+    for (int v = 0; v < vertices; ++v) {
+        chain.clear();
+        int u = v;
+        while (u >= 0 && u < vertices && state[u] == 0) {
+            state[u] = 1;
+            chain.push_back(u);
+            u = parents[u];
+        }
+        bool cycle = u >= 0 && u < vertices && state[u] == 1;
+        errors += cycle;
+        for (int w : chain) {
+            state[w] = 2;
+        }
+    }
+    return errors;
+}
+
+// Расстояния хранятся в int с INF = INT_MAX / 2. Ребро с |w| >= INF
+// не представимо: dist[u] + w переполнило бы int, поэтому такой граф
+// отвергается целиком. Возвращает true, если самый длинный простой путь
+// (V - 1) * max|w| может дойти до INF: тогда расстояния надо проверять
+// find_truncated_distance
+inline bool distances_may_overflow(const CSRGraph& graph) {
+    const int* weights = graph.weights();
+    size_t edges = graph.get_edges_count();
+    long long max_weight = 0;
+    #pragma omp parallel for reduction(max:max_weight)
+    for (size_t e = 0; e < edges; ++e) {
+        max_weight = std::max(max_weight, std::abs(static_cast<long long>(weights[e])));
+    }
+    if (max_weight >= INF) {
+        throw std::invalid_argument("Edge weight " + std::to_string(max_weight)
+                                    + " does not fit: distances are int with INF = " + std::to_string(INF));
+    }
+    return static_cast<long long>(std::max(graph.get_vertices() - 1, 0)) * max_weight >= INF;
+}
+
+// Путь длиной INF и больше движок не находит: новое расстояние не
+// меньше INF, и вершина молча остается недостижимой. Ее выдает ребро
+// u -> v с конечным dist[u] и dist[v] == INF. Возвращает v или -1
+inline int find_truncated_distance(const CSRGraph& graph, const int* dist) {
+    const size_t* offsets = graph.offsets();
+    const int* targets = graph.targets();
+    for (int u = 0; u < graph.get_vertices(); ++u) {
+        if (dist[u] >= INF) {
+            continue;
+        }
+        for (size_t e = offsets[u]; e < offsets[u + 1]; ++e) {
+            if (dist[targets[e]] >= INF) {
+                return targets[e];
+            }
+        }
+    }
+    return -1;
+}
+
+// Подготовка движка с метками int или PackedLabel по EngineOptions::parents
+template <template <typename> class Engine>
+EngineHandle prepare_labeled(const CSRGraph& graph, const EngineOptions& options) {
+    if (options.parents) {
+        return std::make_unique<Engine<PackedLabel>>(graph, options);
+    }
+    return std::make_unique<Engine<int>>(graph, options);
+}
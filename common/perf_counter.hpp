@@ -0,0 +1,73 @@
+#pragma once
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+// Счетчик промахов последнего уровня кэша (LLC) через perf_event_open.
+// Считаются промахи чтения всех потоков процесса, созданных после
+// открытия счетчика, только в пространстве пользователя. Если счетчик
+// недоступен (не Linux, нет PMU в виртуальной машине, запрет
+// perf_event_paranoid), available() возвращает false, а stop() — -1.
+class CacheMissCounter {
+    int fd = -1;
+
+public:
+    CacheMissCounter() {
+        #ifdef __linux__
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_LL | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+            | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+        #endif
+    }
+
+    ~CacheMissCounter() {
+        #ifdef __linux__
+        if (fd != -1) {
+            close(fd);
+        }
+        #endif
+    }
+
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    bool available() const {
+        return fd != -1;
+    }
+
+    void start() {
+        #ifdef __linux__
+        if (fd != -1) {
+            ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+        }
+        #endif
+    }
+
+    // Число промахов с последнего start()
+    long long stop() {
+        #ifdef __linux__
+        if (fd != -1) {
+            ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+            long long count = 0;
+            if (read(fd, &count, sizeof(count)) == static_cast<ssize_t>(sizeof(count))) {
+                return count;
+            }
+        }
+        #endif
+        return -1;
+    }
+};
@@ -0,0 +1,461 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "graph.hpp"
+#include "engine.hpp"
+#include "negative_cycle.hpp"
+
+// Перенумерация вершин для локальности доступа к dist: соседние по
+// графу вершины получают близкие номера, поэтому чтения dist[targets[e]]
+// чаще попадают в уже загруженные строки кэша. Граф перенумеровывается
+// один раз, движки работают на нем, а расстояния переводятся обратно
+// в исходные номера оберткой ReorderedEngine.
+namespace reordering {
+
+// Ненаправленная смежность: исходящие и входящие ребра вершины
+class Neighbors {
+    CSRGraph graph;
+    CSRGraph incoming;
+
+public:
+    explicit Neighbors(const CSRGraph& graph) : graph(graph), incoming(graph.transpose()) {}
+
+    template <typename Visit>
+    void for_each(int u, Visit visit) const {
+        for (size_t e = graph.offsets()[u]; e < graph.offsets()[u + 1]; ++e) {
+            visit(graph.targets()[e]);
+        }
+        for (size_t e = incoming.offsets()[u]; e < incoming.offsets()[u + 1]; ++e) {
+            visit(incoming.targets()[e]);
+        }
+    }
+
+    int degree(int u) const {
+        return static_cast<int>(graph.degree(u) + incoming.degree(u));
+    }
+
+    const CSRGraph& out() const {
+        return graph;
+    }
+
+    const CSRGraph& in() const {
+        return incoming;
+    }
+};
+
+// Все функции порядка возвращают последовательность старых номеров
+// в новом порядке (order[new] = old)
+
+// По убыванию суммарной степени: концентраторы в начале массива
+inline std::vector<int> degree_order(const Neighbors& neighbors, int vertices) {
+    std::vector<int> order(vertices);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+        return neighbors.degree(a) > neighbors.degree(b);
+    });
+    return order;
+}
+
+// Обход в ширину по ненаправленной смежности; компоненты связности
+// начинаются с вершины с наименьшим номером, при by_degree — с
+// наименьшей степенью, а соседи берутся по возрастанию степени
+// (порядок Катхилла-Макки)
+inline std::vector<int> bfs_order(const Neighbors& neighbors, int vertices, bool by_degree) {
+    std::vector<int> order;
+    order.reserve(vertices);
+    std::vector<char> visited(vertices, 0);
+    std::vector<int> roots(vertices);
+    std::iota(roots.begin(), roots.end(), 0);
+    if (by_degree) {
+        std::stable_sort(roots.begin(), roots.end(), [&](int a, int b) {
+            return neighbors.degree(a) < neighbors.degree(b);
+        });
+    }
+
+    std::vector<int> children;
+    for (int root : roots) {
+        if (visited[root]) {
+            continue;
+        }
+        visited[root] = 1;
+        size_t head = order.size();
+        order.push_back(root);
+        while (head < order.size()) {
+            int u = order[head++];
+            children.clear();
+            neighbors.for_each(u, [&](int v) {
+                if (!visited[v]) {
+                    visited[v] = 1;
+                    children.push_back(v);
+                }
+            });
+            if (by_degree) {
+                std::stable_sort(children.begin(), children.end(), [&](int a, int b) {
+                    return neighbors.degree(a) < neighbors.degree(b);
+                });
+            }
+            order.insert(order.end(), children.begin(), children.end());
+        }
+    }
+    return order;
+}
+
+// Обратный порядок Катхилла-Макки: уменьшает ширину ленты матрицы смежности
+inline std::vector<int> rcm_order(const Neighbors& neighbors, int vertices) {
+    std::vector<int> order = bfs_order(neighbors, vertices, true);
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+// Прямой порядок обхода в глубину по ненаправленной смежности
+inline std::vector<int> dfs_order(const Neighbors& neighbors, int vertices) {
+    std::vector<int> order;
+    order.reserve(vertices);
+    std::vector<char> visited(vertices, 0);
+    std::vector<int> stack;
+    for (int root = 0; root < vertices; ++root) {
+        if (visited[root]) {
+            continue;
+        }
+        stack.push_back(root);
+        while (!stack.empty()) {
+            int u = stack.back();
+            stack.pop_back();
+            if (visited[u]) {
+                continue;
+            }
+            visited[u] = 1;
+            order.push_back(u);
+            neighbors.for_each(u, [&](int v) {
+                if (!visited[v]) {
+                    stack.push_back(v);
+                }
+            });
+        }
+    }
+    return order;
+}
+
+// Очередь с приоритетом для счетчиков, меняющихся на единицу: вершины
+// лежат в двусвязных списках по значению счетчика, изменение и удаление —
+// O(1), указатель на наибольший непустой список сдвигается лениво
+class UnitHeap {
+    std::vector<int> heads;
+    std::vector<int> next;
+    std::vector<int> prev;
+    std::vector<int> key;
+    int top = 0;
+
+    void link(int v) {
+        if (key[v] >= static_cast<int>(heads.size())) {
+            heads.resize(key[v] + 1, -1);
+        }
+        next[v] = heads[key[v]];
+        prev[v] = -1;
+        if (next[v] != -1) {
+            prev[next[v]] = v;
+        }
+        heads[key[v]] = v;
+        top = std::max(top, key[v]);
+    }
+
+    void unlink(int v) {
+        if (prev[v] != -1) {
+            next[prev[v]] = next[v];
+        } else {
+            heads[key[v]] = next[v];
+        }
+        if (next[v] != -1) {
+            prev[next[v]] = prev[v];
+        }
+    }
+
+public:
+    // Все вершины с нулевым ключом, в начале списка — меньшие номера
+    explicit UnitHeap(int vertices) : heads(1, -1), next(vertices), prev(vertices), key(vertices, 0) {
+        for (int v = vertices - 1; v >= 0; --v) {
+            link(v);
+        }
+    }
+
+    void change(int v, int delta) {
+        unlink(v);
+        key[v] += delta;
+        link(v);
+    }
+
+    void erase(int v) {
+        unlink(v);
+        key[v] = -1;
+    }
+
+    bool contains(int v) const {
+        return key[v] >= 0;
+    }
+
+    // Вершина с наибольшим ключом; очередь не пуста
+    int max() {
+        while (heads[top] == -1) {
+            --top;
+        }
+        return heads[top];
+    }
+};
+
+// Упрощенный Gorder: жадно выбирается вершина с наибольшим числом связей
+// с последними window размещенными — прямых ребер в обе стороны и общих
+// входящих соседей. Концентраторы со степенью больше hub_degree не
+// учитываются как общие соседи, иначе стоимость растет квадратично.
+inline std::vector<int> gorder_order(const Neighbors& neighbors, int vertices, int window = 5, size_t hub_degree = 64) {
+    std::vector<int> order;
+    order.reserve(vertices);
+    UnitHeap heap(vertices);
+    const CSRGraph& out = neighbors.out();
+    const CSRGraph& in = neighbors.in();
+
+    auto update = [&](int v, int delta) {
+        auto bump = [&](int u) {
+            if (heap.contains(u)) {
+                heap.change(u, delta);
+            }
+        };
+        neighbors.for_each(v, bump);
+        for (size_t e = in.offsets()[v]; e < in.offsets()[v + 1]; ++e) {
+            int parent = in.targets()[e];
+            if (out.degree(parent) > hub_degree) {
+                continue;
+            }
+            for (size_t f = out.offsets()[parent]; f < out.offsets()[parent + 1]; ++f) {
+                if (out.targets()[f] != v) {
+                    bump(out.targets()[f]);
+                }
+            }
+        }
+    };
+
+    // Начало — вершина с наибольшей входящей степенью
+    int v = 0;
+    for (int u = 1; u < vertices; ++u) {
+        if (in.degree(u) > in.degree(v)) {
+            v = u;
+        }
+    }
+    while (true) {
+        heap.erase(v);
+        order.push_back(v);
+        if (static_cast<int>(order.size()) == vertices) {
+            break;
+        }
+        update(v, 1);
+        if (static_cast<int>(order.size()) > window) {
+            update(order[order.size() - window - 1], -1);
+        }
+        v = heap.max();
+    }
+    return order;
+}
+
+inline bool is_known_method(const std::string& method) {
+    return method == "none" || method == "degree" || method == "bfs" || method == "dfs"
+        || method == "rcm" || method == "gorder";
+}
+
+// Разбор списка методов через запятую, например "none,rcm,gorder"
+inline std::vector<std::string> parse_methods(const std::string& text) {
+    std::vector<std::string> methods;
+    size_t begin = 0;
+    while (begin <= text.size()) {
+        size_t end = text.find(',', begin);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string method = text.substr(begin, end - begin);
+        if (!is_known_method(method)) {
+            throw std::invalid_argument("unknown reordering method: " + method);
+        }
+        methods.push_back(method);
+        begin = end + 1;
+    }
+    return methods;
+}
+
+// Новые номера вершин по названию метода: new_id[old] = new
+inline std::vector<int> compute_new_ids(const CSRGraph& graph, const std::string& method) {
+    int vertices = graph.get_vertices();
+    std::vector<int> order;
+    if (method == "none") {
+        order.resize(vertices);
+        std::iota(order.begin(), order.end(), 0);
+    } else {
+        if (!is_known_method(method)) {
+            throw std::invalid_argument("Unknown reordering method: " + method);
+        }
+        Neighbors neighbors(graph);
+        if (method == "degree") {
+            order = degree_order(neighbors, vertices);
+        } else if (method == "bfs") {
+            order = bfs_order(neighbors, vertices, false);
+        } else if (method == "dfs") {
+            order = dfs_order(neighbors, vertices);
+        } else if (method == "rcm") {
+            order = rcm_order(neighbors, vertices);
+        } else {
+            order = gorder_order(neighbors, vertices);
+        }
+    }
+    std::vector<int> new_id(vertices);
+    for (int i = 0; i < vertices; ++i) {
+        new_id[order[i]] = i;
+    }
+    return new_id;
+}
+
+// Граф с вершинами, перенумерованными по new_id; строки отсортированы
+// по новому номеру получателя
+inline CSRGraph relabel(const CSRGraph& graph, const std::vector<int>& new_id) {
+    int vertices = graph.get_vertices();
+    std::vector<int> old_id(vertices);
+    for (int v = 0; v < vertices; ++v) {
+        old_id[new_id[v]] = v;
+    }
+    std::vector<size_t> offsets(static_cast<size_t>(vertices) + 1, 0);
+    for (int v = 0; v < vertices; ++v) {
+        offsets[v + 1] = offsets[v] + graph.degree(old_id[v]);
+    }
+
+    // Получатель и вес упакованы в один ключ, как в transpose
+    size_t edges = graph.get_edges_count();
+    std::vector<uint64_t> packed(edges);
+    std::vector<int> targets(edges);
+    std::vector<int> weights(edges);
+    const size_t* old_offsets = graph.offsets();
+    const int* old_targets = graph.targets();
+    const int* old_weights = graph.weights();
+    #pragma omp parallel for schedule(dynamic, 1024)
+    for (int v = 0; v < vertices; ++v) {
+        int u = old_id[v];
+        size_t position = offsets[v];
+        for (size_t e = old_offsets[u]; e < old_offsets[u + 1]; ++e, ++position) {
+            packed[position] = (static_cast<uint64_t>(new_id[old_targets[e]]) << 32)
+                | (static_cast<uint32_t>(old_weights[e]) ^ 0x80000000u);
+        }
+        std::sort(packed.begin() + offsets[v], packed.begin() + offsets[v + 1]);
+        for (size_t e = offsets[v]; e < offsets[v + 1]; ++e) {
+            targets[e] = static_cast<int>(packed[e] >> 32);
+            weights[e] = static_cast<int>(static_cast<uint32_t>(packed[e]) ^ 0x80000000u);
+        }
+    }
+    // Перенумерация сохраняет симметричность
+    CSRGraph relabeled(vertices, std::move(offsets), std::move(targets), std::move(weights));
+    relabeled.mark_undirected(graph.is_undirected());
+    return relabeled;
+}
+
+// Движок на перенумерованном графе с запросами и ответами в исходных номерах
+class ReorderedEngine : public SsspEngine {
+    EngineHandle engine;
+    std::shared_ptr<const std::vector<int>> new_id;
+    std::vector<int> result;
+    std::vector<int> mapped_sources;
+    std::vector<int> mapped_out;
+    std::vector<int> old_id; // обратная перестановка, строится в inverse() при первом обращении
+    std::vector<int> mapped_parents;
+
+    const std::vector<int>& inverse() {
+        const std::vector<int>& ids = *new_id;
+        if (old_id.empty()) {
+            old_id.resize(ids.size());
+            for (size_t v = 0; v < ids.size(); ++v) {
+                old_id[ids[v]] = static_cast<int>(v);
+            }
+        }
+        return old_id;
+    }
+
+    std::vector<int> to_old_ids(std::vector<int> vertices) {
+        const std::vector<int>& old = inverse();
+        for (int& v : vertices) {
+            v = old[v];
+        }
+        return vertices;
+    }
+
+    // Свидетель отрицательного цикла переводится в исходные номера
+    const std::vector<int>& solve_mapped(int source) {
+        try {
+            return engine->solve(source);
+        } catch (const NegativeCycleError& e) {
+            throw NegativeCycleError(to_old_ids(e.cycle));
+        }
+    }
+
+public:
+    ReorderedEngine(EngineHandle engine, std::shared_ptr<const std::vector<int>> new_id)
+        : engine(std::move(engine)), new_id(std::move(new_id)), result(this->new_id->size()) {}
+
+    const std::vector<int>& solve(int source) override {
+        const std::vector<int>& ids = *new_id;
+        if (source < 0 || source >= static_cast<int>(ids.size())) {
+            throw std::out_of_range("Source vertex is out of range");
+        }
+        const std::vector<int>& dist = solve_mapped(ids[source]);
+        for (size_t v = 0; v < ids.size(); ++v) {
+            result[v] = dist[ids[v]];
+        }
+        return result;
+    }
+
+    void solve_batch(const std::vector<int>& sources, std::vector<int>& out) override {
+        const std::vector<int>& ids = *new_id;
+        size_t vertices = ids.size();
+        mapped_sources.resize(sources.size());
+        for (size_t i = 0; i < sources.size(); ++i) {
+            if (sources[i] < 0 || sources[i] >= static_cast<int>(vertices)) {
+                throw std::out_of_range("Source vertex is out of range");
+            }
+            mapped_sources[i] = ids[sources[i]];
+        }
+        mapped_out.resize(out.size());
+        try {
+            engine->solve_batch(mapped_sources, mapped_out);
+        } catch (const NegativeCycleError& e) {
+            throw NegativeCycleError(to_old_ids(e.cycle));
+        }
+        for (size_t i = 0; i < sources.size(); ++i) {
+            const int* row = mapped_out.data() + i * vertices;
+            int* out_row = out.data() + i * vertices;
+            for (size_t v = 0; v < vertices; ++v) {
+                out_row[v] = row[ids[v]];
+            }
+        }
+    }
+
+    WorkCounters* counters() override {
+        return engine->counters();
+    }
+
+    // Предки переводятся в исходные номера при каждом вызове
+    const std::vector<int>* parents() override {
+        const std::vector<int>* inner = engine->parents();
+        if (!inner) {
+            return nullptr;
+        }
+        const std::vector<int>& ids = *new_id;
+        const std::vector<int>& old = inverse();
+        mapped_parents.resize(ids.size());
+        for (size_t v = 0; v < ids.size(); ++v) {
+            int parent = (*inner)[ids[v]];
+            mapped_parents[v] = parent < 0 ? -1 : old[parent];
+        }
+        return &mapped_parents;
+    }
+};
+
+} // namespace reordering
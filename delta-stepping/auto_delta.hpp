@@ -0,0 +1,74 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <vector>
+#include "../common/graph.hpp"
+#include "../common/engine.hpp"
+
+// Автоматический выбор ширины ведра дельта-шага.
+// Оценка по Мейеру-Сандерсу: при случайных весах дельта порядка
+// средний вес / средняя степень дает O(1) повторных релаксаций на вершину.
+// Для p потоков ведро расширяется в p раз, чтобы в фазе хватало работы
+// на все потоки. Результат ограничен диапазоном весов: дельта меньше
+// минимального веса не уменьшает число фаз, а больше максимального не
+// отличает легкие ребра от тяжелых.
+inline int heuristic_delta(const CSRGraph& graph, int threads) {
+    size_t edges = graph.get_edges_count();
+    if (edges == 0 || graph.get_vertices() == 0) {
+        return 1;
+    }
+    const int* weights = graph.weights();
+    int min_weight = weights[0];
+    int max_weight = weights[0];
+    double sum = 0;
+    #pragma omp parallel for reduction(min:min_weight) reduction(max:max_weight) reduction(+:sum)
+    for (size_t e = 0; e < edges; ++e) {
+        min_weight = std::min(min_weight, weights[e]);
+        max_weight = std::max(max_weight, weights[e]);
+        sum += weights[e];
+    }
+    double mean_weight = sum / edges;
+    double average_degree = static_cast<double>(edges) / graph.get_vertices();
+    double delta = std::ceil(mean_weight * std::max(threads, 1) / average_degree);
+    delta = std::min(delta, static_cast<double>(max_weight));
+    delta = std::max(delta, static_cast<double>(std::max(min_weight, 1)));
+    return static_cast<int>(delta);
+}
+
+// Уточнение короткой пробой: движок prepare готовится с дельтами от
+// initial / 4 до initial * 4 и решает запросы из нескольких источников,
+// выбирается дельта с наименьшим суммарным временем. Проб всегда пять
+// (дельта не меньше 1, совпадающие не выбрасываются), чтобы процессы MPI
+// делали одинаковое число коллективных вызовов при любой initial
+inline int probe_delta(const CSRGraph& graph, PrepareFn prepare, EngineOptions options, int initial, int samples = 2) {
+    std::vector<int> candidates;
+    for (int factor : {-4, -2, 1, 2, 4}) {
+        long long delta = factor > 0 ? static_cast<long long>(initial) * factor : initial / -factor;
+        candidates.push_back(static_cast<int>(std::clamp<long long>(delta, 1, std::numeric_limits<int>::max())));
+    }
+
+    int vertices = graph.get_vertices();
+    int best_delta = initial;
+    double best_time = -1;
+    for (int delta : candidates) {
+        options.delta = delta;
+        EngineHandle engine = prepare(graph, options);
+        auto start = std::chrono::high_resolution_clock::now();
+        for (int i = 0; i < samples; ++i) {
+            engine->solve(static_cast<int>(static_cast<long long>(i) * vertices / samples));
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        double time = std::chrono::duration<double>(stop - start).count();
+        std::cout << "Проба дельты " << delta << ": " << std::fixed << std::setprecision(6) << time << " секунд" << std::endl;
+        if (best_time < 0 || time < best_time) {
+            best_time = time;
+            best_delta = delta;
+        }
+    }
+    return best_delta;
+}
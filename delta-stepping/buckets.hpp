@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include "../common/engine.hpp"
+
+// Ведра дельта-шага хранятся по кругу. Пока обрабатывается ведро i, все
+// новые расстояния меньше (i + 1) * delta + max_weight, поэтому непустые
+// ведра лежат в окне из ceil(max_weight / delta) + 1 номеров, и ведро b
+// хранится в ячейке b % count. Память не зависит от диапазона расстояний.
+// Все движки дельта-шага получают число ячеек отсюда, поэтому здесь же
+// отвергаются отрицательные веса: с ними ведра теряют порядок и
+// результат молча неверен (для них — Bellman-Ford с поиском циклов).
+constexpr size_t max_cyclic_buckets = size_t(1) << 20;
+
+// Наименьший и наибольший вес ребер; 0 входит в диапазон
+struct WeightRange {
+    long long min = 0;
+    long long max = 0;
+};
+
+template <typename Graph>
+WeightRange weight_range(const Graph& graph) {
+    const auto* weights = graph.weights();
+    size_t edges = graph.get_edges_count();
+    long long max_weight = 0;
+    long long min_weight = 0;
+    #pragma omp parallel for reduction(max:max_weight) reduction(min:min_weight)
+    for (size_t e = 0; e < edges; ++e) {
+        max_weight = std::max(max_weight, static_cast<long long>(weights[e]));
+        min_weight = std::min(min_weight, static_cast<long long>(weights[e]));
+    }
+    return {min_weight, max_weight};
+}
+
+inline size_t cyclic_bucket_count(const WeightRange& range, long long delta) {
+    if (range.min < 0) {
+        throw UnsupportedGraph("Delta-stepping requires non-negative edge weights");
+    }
+    size_t count = static_cast<size_t>((range.max + delta - 1) / delta) + 1;
+    if (count > max_cyclic_buckets) {
+        throw std::invalid_argument("Delta is too small for the maximum edge weight " + std::to_string(range.max)
+                                    + ": " + std::to_string(count) + " buckets needed");
+    }
+    return count;
+}
+
+template <typename Graph>
+size_t cyclic_bucket_count(const Graph& graph, long long delta) {
+    return cyclic_bucket_count(weight_range(graph), delta);
+}
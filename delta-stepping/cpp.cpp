@@ -1,14 +1,19 @@
 #include <vector>
 #include "../common/graph.hpp"
+#include "../common/dijkstra.hpp"
 #include "task.hpp"
 #include "cpp.hpp"
 #include "cpp.hpp"
 
 int main(int argc, char* argv[]) {
-    Task task({Impl{delta_stepping_cpp, "C++"}});
-    task.init(argc, argv);
-    for (int i = 0; i < 10; ++i) {
-        task.run();
+    Task task({
+        Impl{prepare<DeltaSteppingCpp>, "C++", "cpp"},
+        Impl{prepare_compact<BasicDeltaStepping>, "C++ Compact", "compact"},
+        Impl{prepare_dijkstra, "Dijkstra", "dijkstra", false}
+    });
+    int status = task.init(argc, argv);
+    if (status != 0) {
+        return status == Task::DONE ? 0 : status;
     }
-    return 0;
+    return task.benchmark();
 }
@@ -1,140 +1,210 @@
 #pragma once
 
-#include <chrono>
+#include <algorithm>
+#include <tuple>
 #include <vector>
 #include "../common/graph.hpp"
-
-class Bucket {
+#include "../common/engine.hpp"
+#include "../common/compact_graph.hpp"
+#include "buckets.hpp"
+
+// Ведра дельта-шага на интрузивных двусвязных списках: у каждой вершины
+// есть ссылки next/prev и номер ведра, поэтому вставка и удаление — O(1),
+// а извлечение ведра пропорционально числу вершин в нем.
+// Ячеек ведер фиксированное число, ведро b лежит в ячейке slot(b)
+// (см. cyclic_bucket_count). Память O(V + число ячеек).
+class BucketQueue {
 private:
-    std::vector<int> data;
+    std::vector<int> heads;
+    std::vector<int> next;
+    std::vector<int> prev;
+    std::vector<int> bucket_of;
+
 public:
-    Bucket(int size) : data(size) {}
-    
-    void insert(int index) {
-        data[index] = 1;
-    }
+    BucketQueue(int vertices, size_t slots)
+        : heads(slots, -1), next(vertices, -1), prev(vertices, -1), bucket_of(vertices, -1) {}
 
-    void erase(int index) {
-        data[index] = 0;
+    template <typename Index>
+    int slot(Index bucket) const {
+        return static_cast<int>(bucket % static_cast<Index>(heads.size()));
     }
 
-    bool empty() const {
-        for (int i = 0; i < data.size(); ++i) {
-            if (data[i] == 1) {
-                return false;
-            }
+    void insert(int vertex, int bucket) {
+        int head = heads[bucket];
+        next[vertex] = head;
+        prev[vertex] = -1;
+        if (head != -1) {
+            prev[head] = vertex;
         }
-        return true;
+        heads[bucket] = vertex;
+        bucket_of[vertex] = bucket;
     }
 
-    void union_with(const Bucket& other) {
-        for (int i = 0; i < data.size(); ++i) {
-            data[i] |= other.data[i];
+    void erase(int vertex) {
+        int bucket = bucket_of[vertex];
+        if (bucket == -1) {
+            return;
         }
-    }
-
-    void clear() {
-        for (int i = 0; i < data.size(); ++i) {
-            data[i] = 0;
+        if (prev[vertex] != -1) {
+            next[prev[vertex]] = next[vertex];
+        } else {
+            heads[bucket] = next[vertex];
+        }
+        if (next[vertex] != -1) {
+            prev[next[vertex]] = prev[vertex];
         }
+        bucket_of[vertex] = -1;
     }
 
-    std::vector<int> get_vertices() const {
-        std::vector<int> vertices;
-        for (int i = 0; i < data.size(); ++i) {
-            if (data[i] == 1) {
-                vertices.push_back(i);
-            }
+    // Перемещение вершины в другое ведро (или вставка, если ее нет ни в одном)
+    void move(int vertex, int bucket) {
+        if (bucket_of[vertex] == bucket) {
+            return;
         }
-        return vertices;
+        erase(vertex);
+        insert(vertex, bucket);
     }
-};
 
-void relax(int u, int v, int weight, int delta, std::vector<int>& distances, std::vector<Bucket>& buckets) {
-    if (distances[v] > distances[u] + weight) {
-        int old_bucket = (distances[v] == INF) ? -1 : distances[v] / delta;
-        distances[v] = distances[u] + weight;
-        int new_bucket = distances[v] / delta;
+    bool empty(int bucket) const {
+        return heads[bucket] == -1;
+    }
 
-        if (new_bucket >= buckets.size()) {
-            buckets.resize(new_bucket + 1, Bucket(distances.size()));
-        }
-        
-        if (old_bucket != -1) {
-            buckets[old_bucket].erase(v);
+    // Извлечение всех вершин ведра в out (out предварительно очищается)
+    void extract(int bucket, std::vector<int>& out) {
+        out.clear();
+        for (int vertex = heads[bucket]; vertex != -1; vertex = next[vertex]) {
+            out.push_back(vertex);
+            bucket_of[vertex] = -1;
         }
-        buckets[new_bucket].insert(v);
+        heads[bucket] = -1;
     }
-}
-
-std::vector<int> delta_stepping_cpp(const std::vector<std::vector<std::pair<int, int>>>& adj_matrix, int source, int delta, std::chrono::duration<double>& duration) {
-    int max_edge_weight = 100;
 
-    int num_vertices = adj_matrix.size();
-    
-    std::vector<int> distances(num_vertices, INF);
-    std::vector<Bucket> buckets(max_edge_weight / delta + 1, Bucket(num_vertices));
+    int size() const {
+        return static_cast<int>(heads.size());
+    }
 
-    std::vector<std::vector<std::pair<int, int>>> light_adj_matrix(num_vertices);
-    for (int u = 0; u < adj_matrix.size(); ++u) {
-        for (int v = 0; v < adj_matrix[u].size(); ++v) {
-            if (adj_matrix[u][v].second < delta) {
-                light_adj_matrix[u].push_back(adj_matrix[u][v]);
+    // Число шагов по кругу от ячейки from до ближайшей непустой, -1 — все пусты
+    int steps_to_nonempty(int from) const {
+        int count = size();
+        for (int steps = 0; steps < count; ++steps) {
+            int bucket = from + steps < count ? from + steps : from + steps - count;
+            if (heads[bucket] != -1) {
+                return steps;
             }
         }
+        return -1;
     }
+};
 
-    std::vector<std::vector<std::pair<int, int>>> heavy_adj_matrix(num_vertices);
-    for (int u = 0; u < adj_matrix.size(); ++u) {
-        for (int v = 0; v < adj_matrix[u].size(); ++v) {
-            if (adj_matrix[u][v].second >= delta) {
-                heavy_adj_matrix[u].push_back(adj_matrix[u][v]);
-            }
+// parents — массив предков или nullptr, если дерево путей не строится
+template <typename Distance>
+void relax(int u, int v, Distance weight, Distance delta, std::vector<Distance>& distances, BucketQueue& buckets,
+           int* parents SSSP_COUNT(, ThreadWork& counted)) {
+    Distance new_distance = distances[u] + weight;
+    if (new_distance < distances[v]) {
+        SSSP_COUNT(++counted.relax_success; counted.reinsertions += distances[v] < distance_inf<Distance>());
+        distances[v] = new_distance;
+        if (parents) {
+            parents[v] = u;
         }
+        buckets.move(v, buckets.slot(new_distance / delta));
     }
+}
 
-    auto start = std::chrono::high_resolution_clock::now();
+// Легкие и тяжелые ребра разделяются один раз при подготовке, буферы
+// переиспользуются между запросами, поэтому solve не выделяет память.
+// Граф и тип расстояний — параметры шаблона, как у BasicBellmanFordFrontier
+template <typename Graph, typename Distance>
+class BasicDeltaStepping : public SsspEngine {
+    Graph graph;
+    Graph light_graph;
+    Graph heavy_graph;
+    Distance delta;
+    std::vector<Distance> distances;
+    BucketQueue buckets;
+    std::vector<int> current_vertices;
+    std::vector<int> settled_vertices;
+    std::vector<int> settled_bucket;
+    std::vector<int> result;
+    std::vector<int> parent; // пусто, если предки не нужны
 
-    // Проверка входных данных
-    if (source < 0 || source >= num_vertices) {
-        throw std::out_of_range("Source vertex is out of range");
+public:
+    BasicDeltaStepping(const CSRGraph& graph, const EngineOptions& options)
+        : graph(graph), delta(static_cast<Distance>(options.delta)), distances(graph.get_vertices()),
+          buckets(graph.get_vertices(), options.delta > 0 ? cyclic_bucket_count(graph, options.delta) : 1),
+          settled_bucket(graph.get_vertices()), parent(options.parents ? graph.get_vertices() : 0) {
+        if (options.delta <= 0) {
+            throw std::invalid_argument("Delta must be positive");
+        }
+        std::tie(light_graph, heavy_graph) = this->graph.split_by_weight(delta);
+        current_vertices.reserve(graph.get_vertices());
+        settled_vertices.reserve(graph.get_vertices());
     }
-    if (delta <= 0) {
-        throw std::invalid_argument("Delta must be positive");
+
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>* parents() override {
+        return parent.empty() ? nullptr : &parent;
     }
 
-    // Инициализация
-    distances[source] = 0;
-    buckets[0].insert(source);
-
-    // Основной цикл алгоритма
-    for (int current_bucket_num = 0; current_bucket_num < buckets.size(); ++current_bucket_num) {
-        Bucket SBucket(num_vertices);
-        while (!buckets[current_bucket_num].empty()) {
-            Bucket current_bucket = buckets[current_bucket_num];
-            SBucket.union_with(current_bucket);
-            buckets[current_bucket_num] = Bucket(num_vertices);
-            std::vector<int> current_vertices = current_bucket.get_vertices();
-
-            // Релаксация легких ребер
-            for (int u : current_vertices) {
-                for (const auto& edge : light_adj_matrix[u]) {
-                    relax(u, edge.first, edge.second, delta, distances, buckets);
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        const auto* light_offsets = light_graph.offsets();
+        const auto* light_targets = light_graph.targets();
+        const auto* light_weights = light_graph.weights();
+        const auto* heavy_offsets = heavy_graph.offsets();
+        const auto* heavy_targets = heavy_graph.targets();
+        const auto* heavy_weights = heavy_graph.weights();
+
+        // Инициализация; очередь пуста после предыдущего запроса
+        std::fill(distances.begin(), distances.end(), distance_inf<Distance>());
+        std::fill(settled_bucket.begin(), settled_bucket.end(), -1);
+        std::fill(parent.begin(), parent.end(), -1);
+        int* parents_ptr = parent.empty() ? nullptr : parent.data();
+        distances[source] = 0;
+        buckets.insert(source, 0);
+        SSSP_COUNT(ThreadWork& counted = work.current());
+
+        // Основной цикл алгоритма: ближайшее непустое ведро по кругу,
+        // phase — порядковый номер обработанного ведра
+        int current_slot = 0;
+        for (int phase = 0;; ++phase) {
+            int steps = buckets.steps_to_nonempty(current_slot);
+            if (steps < 0) {
+                break;
+            }
+            current_slot = (current_slot + steps) % buckets.size();
+            settled_vertices.clear();
+            while (!buckets.empty(current_slot)) {
+                buckets.extract(current_slot, current_vertices);
+                SSSP_COUNT(work.phase(current_vertices.size()));
+
+                // Релаксация легких ребер
+                for (int u : current_vertices) {
+                    if (settled_bucket[u] != phase) {
+                        settled_bucket[u] = phase;
+                        settled_vertices.push_back(u);
+                    }
+                    SSSP_COUNT(counted.light_edges += light_offsets[u + 1] - light_offsets[u];
+                               counted.relax_attempts += light_offsets[u + 1] - light_offsets[u]);
+                    for (auto e = light_offsets[u]; e < light_offsets[u + 1]; ++e) {
+                        relax<Distance>(u, light_targets[e], light_weights[e], delta, distances, buckets, parents_ptr SSSP_COUNT(, counted));
+                    }
                 }
             }
-        }
 
-        std::vector<int> current_vertices = SBucket.get_vertices();
-        // Релаксация тяжелых ребер
-        for (int u : current_vertices) {
-            for (const auto& edge : heavy_adj_matrix[u]) {
-                relax(u, edge.first, edge.second, delta, distances, buckets);
+            // Релаксация тяжелых ребер
+            for (int u : settled_vertices) {
+                SSSP_COUNT(counted.heavy_edges += heavy_offsets[u + 1] - heavy_offsets[u];
+                           counted.relax_attempts += heavy_offsets[u + 1] - heavy_offsets[u]);
+                for (auto e = heavy_offsets[u]; e < heavy_offsets[u + 1]; ++e) {
+                    relax<Distance>(u, heavy_targets[e], heavy_weights[e], delta, distances, buckets, parents_ptr SSSP_COUNT(, counted));
+                }
             }
         }
-    }
 
-    auto stop = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start);
+        return export_distances(distances, result);
+    }
+};
 
-    return distances;
-}
\ No newline at end of file
+using DeltaSteppingCpp = BasicDeltaStepping<CSRGraph, int>;
@@ -1,33 +1,32 @@
 #include <sycl/sycl.hpp>
-#include <chrono>
 #include <vector>
 #include "task.hpp"
 #include "cpp.hpp"
 #include "dpc.hpp"
+#include "../common/dijkstra.hpp"
 
-std::vector<int> delta_stepping_dpc_cpu(const std::vector<std::vector<std::pair<int, int>>>& adj_matrix, int source, int delta, std::chrono::duration<double>& duration) {
+EngineHandle prepare_dpc_cpu(const CSRGraph& graph, const EngineOptions& options) {
     q = sycl::queue(sycl::cpu_selector_v);
-    return delta_stepping_dpc(adj_matrix, source, delta, duration);
+    return prepare_labeled<BasicDeltaSteppingDPC>(graph, options);
 }
 
-std::vector<int> delta_stepping_dpc_gpu(const std::vector<std::vector<std::pair<int, int>>>& adj_matrix, int source, int delta, std::chrono::duration<double>& duration) {
+EngineHandle prepare_dpc_gpu(const CSRGraph& graph, const EngineOptions& options) {
     q = sycl::queue(sycl::gpu_selector_v);
-    return delta_stepping_dpc(adj_matrix, source, delta, duration);
+    return prepare_labeled<BasicDeltaSteppingDPC>(graph, options);
 }
 
 int main(int argc, char* argv[]) {
     Impl impl;
     #ifdef DPC_CPU
-    impl = Impl{delta_stepping_dpc_cpu, "DPC++ CPU"};
+    impl = Impl{prepare_dpc_cpu, "DPC++ CPU", "dpc"};
     #else
-    impl = Impl{delta_stepping_dpc_gpu, "DPC++ GPU"};
+    impl = Impl{prepare_dpc_gpu, "DPC++ GPU", "dpc"};
     #endif
 
-    Task task({impl});
-    // Task task({Impl{delta_stepping_cpp, "C++ W/O SET"}, impl});
-    task.init(argc, argv);
-    for (int i = 0; i < 10; i++) {
-        task.run();
+    Task task({impl, Impl{prepare<DeltaSteppingCpp>, "C++", "cpp"}, Impl{prepare_dijkstra, "Dijkstra", "dijkstra", false}});
+    int status = task.init(argc, argv);
+    if (status != 0) {
+        return status == Task::DONE ? 0 : status;
     }
-    return 0;
-}
\ No newline at end of file
+    return task.benchmark();
+}
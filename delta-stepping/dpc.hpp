@@ -1,7 +1,12 @@
 #include <sycl/sycl.hpp>
-#include <chrono>
+#include <algorithm>
+#include <type_traits>
+#include <utility>
 #include <vector>
 #include "../common/graph.hpp"
+#include "../common/engine.hpp"
+#include "../common/paths.hpp"
+#include "buckets.hpp"
 
 sycl::queue q;
 
@@ -38,12 +43,28 @@ public:
     }
 };
 
+// Дескриптор ведра: копируется по значению (в том числе в ядра), память
+// освобождает владелец вызовом release
 class DPCBucket {
 private:
-    int *data;
-    int size;
+    int *data = nullptr;
+    int size = 0;
 public:
-    DPCBucket(int size) : data(sycl::malloc_shared<int>(size, q)), size(size) {}
+    DPCBucket() = default;
+
+    DPCBucket(int size) : data(sycl::malloc_shared<int>(size, q)), size(size) {
+        clear();
+    }
+
+    void release() {
+        sycl::free(data, q);
+        data = nullptr;
+    }
+
+    void swap(DPCBucket& other) {
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+    }
 
     void insert(int index) {
         data[index] = 1;
@@ -123,94 +144,189 @@ public:
     }
 };
 
+// Метка обновляется сравнением с обменом по расстоянию (см. atomic_relax):
+// ведра перекладываются по значению, которое заменил именно этот поток.
+// Label — int или PackedLabel, как у BasicDeltaSteppingDPC
+template <typename Label>
 void relax_dpc(
     int u,
     int v,
     int weight,
-    int *distances,
+    Label *labels,
     DPCBucket *buckets,
+    int buckets_size,
     int delta
 ) {
-    sycl::atomic_ref<int, sycl::memory_order::relaxed, sycl::memory_scope::device, sycl::access::address_space::global_space>
-        atomic_distances(distances[v]);
-
-    int old_bucket = (distances[v] == INF) ? -1 : distances[v] / delta;
-    atomic_distances.fetch_min(distances[u] + weight);
-    int new_bucket = distances[v] / delta;
-    
-    if (old_bucket != -1) {
-        buckets[old_bucket].erase(v);
+    sycl::atomic_ref<Label, sycl::memory_order::relaxed, sycl::memory_scope::device, sycl::access::address_space::global_space>
+        atomic_label(labels[v]);
+
+    int new_distance = label_distance(labels[u]) + weight;
+    Label old_label = atomic_label.load();
+    while (new_distance < label_distance(old_label)) {
+        if (atomic_label.compare_exchange_weak(old_label, make_label<Label>(new_distance, u))) {
+            int old_distance = label_distance(old_label);
+            if (old_distance != INF) {
+                buckets[old_distance / delta % buckets_size].erase(v);
+            }
+            buckets[new_distance / delta % buckets_size].insert(v);
+            return;
+        }
     }
-    buckets[new_bucket].insert(v);
 }
 
 
-std::vector<int> delta_stepping_dpc(const std::vector<std::vector<std::pair<int, int>>>& adj_matrix, int source, int delta, std::chrono::duration<double>& duration) {
-    int max_edge_weight = 100;
-
-    int num_vertices = adj_matrix.size();
-    
-    int *distances = sycl::malloc_shared<int>(num_vertices, q);
-    for (int i = 0; i < num_vertices; i++) {
-        distances[i] = INF;
-    }
-    distances[source] = 0;
+// Плотные матрицы легких и тяжелых ребер, расстояния и ведра
+// создаются один раз при подготовке и переиспользуются между запросами.
+// Ведра хранятся по кругу, их число задается максимальным весом ребра
+// (см. cyclic_bucket_count). Label — int (только расстояния) или
+// PackedLabel (расстояние с предком в одном слове, см. prepare_labeled)
+template <typename Label>
+class BasicDeltaSteppingDPC : public SsspEngine {
+    CSRGraph graph;
+    int delta;
+    int buckets_size;
+    Label *labels;
+    DPCBucket *buckets;
+    DPCBucket settled;  // вершины, прошедшие через текущее ведро за фазу
+    DPCBucket spare;    // пустое ведро на замену текущему
+    int **light_adj_matrix;
+    int **heavy_adj_matrix;
+    std::vector<int> result;
+    std::vector<int> parent;
 
-    int buckets_size = (max_edge_weight / delta) * 3;
-    DPCBucket *buckets = sycl::malloc_shared<DPCBucket>(buckets_size, q);
-    for (int i = 0; i < buckets_size; i++) {
-        buckets[i] = DPCBucket(num_vertices);
-    }
-    buckets[0].insert(source);
-
-    int **light_adj_matrix = sycl::malloc_shared<int*>(num_vertices, q);
-    int **heavy_adj_matrix = sycl::malloc_shared<int*>(num_vertices, q);
-    for (int i = 0; i < num_vertices; i++) {
-        light_adj_matrix[i] = sycl::malloc_shared<int>(num_vertices, q);
-        heavy_adj_matrix[i] = sycl::malloc_shared<int>(num_vertices, q);
-        for (int j = 0; j < num_vertices; j++) {
-            light_adj_matrix[i][j] = INF;
-            heavy_adj_matrix[i][j] = INF;
+public:
+    BasicDeltaSteppingDPC(const CSRGraph& graph, const EngineOptions& options) : graph(graph), delta(options.delta) {
+        if (delta <= 0) {
+            throw std::invalid_argument("Delta must be positive");
         }
+        int num_vertices = graph.get_vertices();
+        const size_t* offsets = graph.offsets();
+        const int* targets = graph.targets();
+        const int* weights = graph.weights();
+
+        labels = sycl::malloc_shared<Label>(num_vertices, q);
+        result.resize(num_vertices);
+
+        buckets_size = static_cast<int>(cyclic_bucket_count(graph, delta));
+        buckets = sycl::malloc_shared<DPCBucket>(buckets_size, q);
+        for (int i = 0; i < buckets_size; i++) {
+            buckets[i] = DPCBucket(num_vertices);
+        }
+        settled = DPCBucket(num_vertices);
+        spare = DPCBucket(num_vertices);
+
+        light_adj_matrix = sycl::malloc_shared<int*>(num_vertices, q);
+        heavy_adj_matrix = sycl::malloc_shared<int*>(num_vertices, q);
+        for (int i = 0; i < num_vertices; i++) {
+            light_adj_matrix[i] = sycl::malloc_shared<int>(num_vertices, q);
+            heavy_adj_matrix[i] = sycl::malloc_shared<int>(num_vertices, q);
+            for (int j = 0; j < num_vertices; j++) {
+                light_adj_matrix[i][j] = INF;
+                heavy_adj_matrix[i][j] = INF;
+            }
 
-        for (const auto& edge : adj_matrix[i]) {
-            if (edge.second < delta) {
-                light_adj_matrix[i][edge.first] = edge.second;
-            } else {
-                heavy_adj_matrix[i][edge.first] = edge.second;
+            // Из параллельных ребер в матрицу попадает самое легкое
+            for (size_t e = offsets[i]; e < offsets[i + 1]; ++e) {
+                int* cell = weights[e] < delta ? &light_adj_matrix[i][targets[e]] : &heavy_adj_matrix[i][targets[e]];
+                *cell = std::min(*cell, weights[e]);
             }
         }
     }
 
-    auto start = std::chrono::high_resolution_clock::now();
-
-    // Проверка входных данных
-    if (source < 0 || source >= num_vertices) {
-        throw std::out_of_range("Source vertex is out of range");
+    ~BasicDeltaSteppingDPC() override {
+        sycl::free(labels, q);
+        for (int i = 0; i < buckets_size; i++) {
+            buckets[i].release();
+        }
+        sycl::free(buckets, q);
+        settled.release();
+        spare.release();
+        for (int i = 0; i < graph.get_vertices(); i++) {
+            sycl::free(light_adj_matrix[i], q);
+            sycl::free(heavy_adj_matrix[i], q);
+        }
+        sycl::free(light_adj_matrix, q);
+        sycl::free(heavy_adj_matrix, q);
     }
-    if (delta <= 0) {
-        throw std::invalid_argument("Delta must be positive");
+
+    // Ядра на устройстве не считают успешные релаксации; просмотренные
+    // ребра — ячейки строк плотных матриц, по V на вершину фазы
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>* parents() override {
+        return std::is_same_v<Label, int> ? nullptr : &parent;
     }
 
-    // Основной цикл алгоритма
-    for (int current_bucket_num = 0; current_bucket_num < buckets_size; ++current_bucket_num) {
-        DPCBucket SBucket(num_vertices);
-        while (!buckets[current_bucket_num].empty()) {
-            DPCBucket current_bucket = buckets[current_bucket_num];
-            SBucket.union_with(current_bucket);
-            buckets[current_bucket_num] = DPCBucket(num_vertices);
-            Array current_vertices = current_bucket.get_vertices_array();
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        int num_vertices = graph.get_vertices();
+        int delta = this->delta;
+        int buckets_size = this->buckets_size;
+        Label *labels = this->labels;
+        DPCBucket *buckets = this->buckets;
+        int **light_adj_matrix = this->light_adj_matrix;
+        int **heavy_adj_matrix = this->heavy_adj_matrix;
+
+        for (int i = 0; i < num_vertices; i++) {
+            labels[i] = make_label<Label>(INF, -1);
+        }
+        labels[source] = make_label<Label>(0, -1);
+        for (int i = 0; i < buckets_size; i++) {
+            buckets[i].clear();
+        }
+        buckets[0].insert(source);
+
+        // Основной цикл алгоритма: ведра обходятся по кругу, пока подряд
+        // не встретится buckets_size пустых
+        int empty_run = 0;
+        for (int current_bucket_num = 0; empty_run < buckets_size; current_bucket_num = (current_bucket_num + 1) % buckets_size) {
+            if (buckets[current_bucket_num].empty()) {
+                ++empty_run;
+                continue;
+            }
+            empty_run = 0;
+            settled.clear();
+            while (!buckets[current_bucket_num].empty()) {
+                // Текущее ведро меняется местами с пустым: релаксация
+                // заполняет новое, а вершины фазы берутся из старого
+                spare.clear();
+                buckets[current_bucket_num].swap(spare);
+                settled.union_with(spare);
+                Array current_vertices = spare.get_vertices_array();
+                SSSP_COUNT(work.phase(current_vertices.get_size());
+                           work.current().light_edges += static_cast<long long>(current_vertices.get_size()) * num_vertices);
+
+                // Релаксация легких ребер
+                auto current_vertices_data = current_vertices.get_data();
+                q.submit([&](sycl::handler& h) {
+                    h.parallel_for(sycl::range<2>(current_vertices.get_size(), num_vertices), [=](sycl::id<2> id) {
+                        int u = current_vertices_data[id[0]];
+                        int v = id[1];
+                        int weight = light_adj_matrix[u][v];
+
+                        if (label_distance(labels[v]) > label_distance(labels[u]) + weight) {
+                            relax_dpc(u, v, weight, labels, buckets, buckets_size, delta);
+                        }
+                    });
+                });
+                q.wait();
+
+                sycl::free(current_vertices_data, q);
+            }
 
-            // Релаксация легких ребер
+            Array current_vertices = settled.get_vertices_array();
+            SSSP_COUNT(work.current().heavy_edges += static_cast<long long>(current_vertices.get_size()) * num_vertices);
+            // Релаксация тяжелых ребер
             auto current_vertices_data = current_vertices.get_data();
+
             q.submit([&](sycl::handler& h) {
                 h.parallel_for(sycl::range<2>(current_vertices.get_size(), num_vertices), [=](sycl::id<2> id) {
                     int u = current_vertices_data[id[0]];
                     int v = id[1];
-                    int weight = light_adj_matrix[u][v];
+                    int weight = heavy_adj_matrix[u][v];
 
-                    if (distances[v] > distances[u] + weight) {
-                        relax_dpc(u, v, weight, distances, buckets, delta);
+                    if (label_distance(labels[v]) > label_distance(labels[u]) + weight) {
+                        relax_dpc(u, v, weight, labels, buckets, buckets_size, delta);
                     }
                 });
             });
@@ -219,39 +335,14 @@ std::vector<int> delta_stepping_dpc(const std::vector<std::vector<std::pair<int,
             sycl::free(current_vertices_data, q);
         }
 
-        Array current_vertices = SBucket.get_vertices_array();
-        // Релаксация тяжелых ребер
-        auto current_vertices_data = current_vertices.get_data();
-
-        q.submit([&](sycl::handler& h) {
-            h.parallel_for(sycl::range<2>(current_vertices.get_size(), num_vertices), [=](sycl::id<2> id) {
-                int u = current_vertices_data[id[0]];
-                int v = id[1];
-                int weight = heavy_adj_matrix[u][v];
-
-                if (distances[v] > distances[u] + weight) {
-                    relax_dpc(u, v, weight, distances, buckets, delta);
-                }
-            });
-        });
-        q.wait();
-
-        sycl::free(current_vertices_data, q);
-    }
-
-    auto stop = std::chrono::high_resolution_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start);
-
-    std::vector<int> result(distances, distances + num_vertices);
-
-    sycl::free(distances, q);
-    sycl::free(buckets, q);
-    for (int i = 0; i < num_vertices; i++) {
-        sycl::free(light_adj_matrix[i], q);
-        sycl::free(heavy_adj_matrix[i], q);
+        SSSP_COUNT(work.current().relax_attempts = work.current().light_edges + work.current().heavy_edges);
+        if constexpr (std::is_same_v<Label, int>) {
+            std::copy(labels, labels + num_vertices, result.begin());
+        } else {
+            unpack_labels(labels, num_vertices, result, parent);
+        }
+        return result;
     }
-    sycl::free(light_adj_matrix, q);
-    sycl::free(heavy_adj_matrix, q);
+};
 
-    return result;
-}
+using DeltaSteppingDPC = BasicDeltaSteppingDPC<int>;
@@ -0,0 +1,49 @@
+#include <vector>
+#include <mpi.h>
+#include "../common/graph.hpp"
+#include "../common/dijkstra.hpp"
+#include "../common/distributed.hpp"
+#include "task.hpp"
+#include "cpp.hpp"
+#include "mpi.hpp"
+
+// Запуск: mpirun -np N ./main-mpi.o [--reference] [опции]. Движок MPI
+// каждого процесса хранит и читает только свои строки графа (у бинарного
+// файла — только их байты; случайный граф и текстовые форматы каждый
+// процесс строит целиком). С --reference процесс 0 дополнительно считает
+// весь граф эталонными реализациями для сверки. Выводит и сохраняет
+// результаты только процесс 0.
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+    int rank = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    distributed::silence_other_ranks(MPI_COMM_WORLD);
+    std::vector<char*> arguments = distributed::rank_arguments(argc, argv, MPI_COMM_WORLD);
+    bool reference = distributed::take_flag(arguments, "--reference");
+
+    int status = 0;
+    {
+        std::vector<Impl> impls{Impl{prepare<DeltaSteppingMPI>, "MPI", "mpi"}};
+        if (reference) {
+            impls.push_back(Impl{distributed::on_rank_zero<prepare<DeltaSteppingCpp>>, "C++", "cpp"});
+            impls.push_back(Impl{distributed::on_rank_zero<prepare_dijkstra>, "Dijkstra", "dijkstra", false});
+        }
+        Task task(impls);
+        if (rank != 0) {
+            task.read_own_rows_only();
+        }
+        status = task.init(static_cast<int>(arguments.size()) - 1, arguments.data());
+        if (status == 0) {
+            status = task.benchmark();
+        } else if (status == Task::DONE) {
+            status = 0;
+        }
+    }
+    if (status != 0) {
+        // Ошибка могла случиться только на одном процессе (например,
+        // проверка графа на процессе 0), остальные ждали бы его в обмене
+        MPI_Abort(MPI_COMM_WORLD, status);
+    }
+    MPI_Finalize();
+    return status;
+}
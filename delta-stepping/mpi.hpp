@@ -0,0 +1,152 @@
+#pragma once
+
+#include <climits>
+#include <stdexcept>
+#include <tuple>
+#include <vector>
+#include <mpi.h>
+#include "../common/graph.hpp"
+#include "../common/engine.hpp"
+#include "../common/distributed.hpp"
+#include "buckets.hpp"
+#include "cpp.hpp"
+
+// Распределенный дельта-шаг: вершины делятся между процессами блоками
+// (distributed::Partition), у процесса свои легкие и тяжелые ребра и
+// свои ведра (BucketQueue по локальным номерам вершин). Номер текущего
+// ведра — минимум ближайших непустых ведер всех процессов (MPI_Allreduce).
+// Легкие фазы повторяются, пока текущее ведро не пусто хотя бы на одном
+// процессе; запросы к чужим вершинам каждой фазы и тяжелого шага уходят
+// одним обменом (distributed::RelaxExchange). Число ячеек ведер
+// одинаково на всех процессах, оно считается по весам всего графа
+// (максимум по процессам).
+class DeltaSteppingMPI : public SsspEngine {
+    MPI_Comm comm = MPI_COMM_WORLD;
+    distributed::Partition partition;
+    CSRGraph light_rows;
+    CSRGraph heavy_rows;
+    int delta;
+    distributed::RelaxExchange exchange;
+    std::vector<int> distances;
+    BucketQueue buckets;
+    std::vector<int> current_vertices;
+    std::vector<int> settled_vertices;
+    std::vector<int> settled_bucket;
+    std::vector<int> result;
+    SSSP_COUNT(std::vector<long long> round_sizes;)
+
+    // Релаксация вершины v (глобальный номер): своя — сразу, чужая — запросом
+    void relax_to(int v, int candidate SSSP_COUNT(, ThreadWork& counted)) {
+        if (partition.owns(v)) {
+            improve(v - partition.first, candidate SSSP_COUNT(, counted));
+        } else {
+            exchange.push(v, candidate);
+        }
+    }
+
+    void improve(int local, int candidate SSSP_COUNT(, ThreadWork& counted)) {
+        if (candidate < distances[local]) {
+            SSSP_COUNT(++counted.relax_success; counted.reinsertions += distances[local] < INF);
+            distances[local] = candidate;
+            buckets.move(local, buckets.slot(candidate / delta));
+        }
+    }
+
+    void apply_received(SSSP_COUNT(ThreadWork& counted)) {
+        for (const distributed::Message& message : exchange.exchange()) {
+            improve(message.vertex - partition.first, message.dist SSSP_COUNT(, counted));
+        }
+    }
+
+public:
+    // Дельта берется у процесса 0, число ячеек ведер — по весам строк
+    // всех процессов: каждый процесс смотрит только свои строки графа
+    DeltaSteppingMPI(const CSRGraph& graph, const EngineOptions& options)
+        : partition(distributed::Partition::block(graph.get_vertices(), comm)),
+          delta(distributed::from_rank_zero(options.delta, comm)), exchange(partition, comm),
+          distances(partition.local_count()), buckets(partition.local_count(), 1),
+          settled_bucket(partition.local_count()) {
+        if (delta <= 0) {
+            throw std::invalid_argument("Delta must be positive");
+        }
+        CSRGraph rows = distributed::local_rows(graph, partition);
+        WeightRange range = weight_range(rows);
+        long long bounds[2] = {-range.min, range.max};
+        MPI_Allreduce(MPI_IN_PLACE, bounds, 2, MPI_LONG_LONG, MPI_MAX, comm);
+        buckets = BucketQueue(partition.local_count(), cyclic_bucket_count(WeightRange{-bounds[0], bounds[1]}, delta));
+        std::tie(light_rows, heavy_rows) = rows.split_by_weight(delta);
+        current_vertices.reserve(partition.local_count());
+        settled_vertices.reserve(partition.local_count());
+    }
+
+    // Фаза — легкая фаза текущего ведра; счетчики процессов собираются
+    // на процессе 0 в конце запроса (distributed::add_counters)
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
+
+    const std::vector<int>& solve(int source) override {
+        if (source < 0 || source >= partition.vertices) {
+            throw std::out_of_range("Source vertex is out of range");
+        }
+        const size_t* light_offsets = light_rows.offsets();
+        const int* light_targets = light_rows.targets();
+        const int* light_weights = light_rows.weights();
+        const size_t* heavy_offsets = heavy_rows.offsets();
+        const int* heavy_targets = heavy_rows.targets();
+        const int* heavy_weights = heavy_rows.weights();
+
+        // Очередь пуста после предыдущего запроса
+        std::fill(distances.begin(), distances.end(), INF);
+        std::fill(settled_bucket.begin(), settled_bucket.end(), -1);
+        if (partition.owns(source)) {
+            distances[source - partition.first] = 0;
+            buckets.insert(source - partition.first, 0);
+        }
+        SSSP_COUNT(ThreadWork counted; round_sizes.clear());
+
+        // current — номер ведра, а не ячейки: по нему процессы
+        // договариваются о следующем ведре, ячейка — buckets.slot(current)
+        int current = 0;
+        for (int phase = 0;; ++phase) {
+            int steps = buckets.steps_to_nonempty(buckets.slot(current));
+            int local_next = steps < 0 ? INT_MAX : current + steps;
+            MPI_Allreduce(&local_next, &current, 1, MPI_INT, MPI_MIN, comm);
+            if (current == INT_MAX) {
+                break;
+            }
+            int current_slot = buckets.slot(current);
+            settled_vertices.clear();
+            while (distributed::any(!buckets.empty(current_slot), comm)) {
+                buckets.extract(current_slot, current_vertices);
+                SSSP_COUNT(round_sizes.push_back(current_vertices.size()));
+
+                // Релаксация легких ребер
+                for (int u : current_vertices) {
+                    if (settled_bucket[u] != phase) {
+                        settled_bucket[u] = phase;
+                        settled_vertices.push_back(u);
+                    }
+                    SSSP_COUNT(counted.light_edges += light_offsets[u + 1] - light_offsets[u];
+                               counted.relax_attempts += light_offsets[u + 1] - light_offsets[u]);
+                    for (size_t e = light_offsets[u]; e < light_offsets[u + 1]; ++e) {
+                        relax_to(light_targets[e], distances[u] + light_weights[e] SSSP_COUNT(, counted));
+                    }
+                }
+                apply_received(SSSP_COUNT(counted));
+            }
+
+            // Релаксация тяжелых ребер
+            for (int u : settled_vertices) {
+                SSSP_COUNT(counted.heavy_edges += heavy_offsets[u + 1] - heavy_offsets[u];
+                           counted.relax_attempts += heavy_offsets[u + 1] - heavy_offsets[u]);
+                for (size_t e = heavy_offsets[u]; e < heavy_offsets[u + 1]; ++e) {
+                    relax_to(heavy_targets[e], distances[u] + heavy_weights[e] SSSP_COUNT(, counted));
+                }
+            }
+            apply_received(SSSP_COUNT(counted));
+        }
+
+        SSSP_COUNT(distributed::add_counters(work, counted, round_sizes, partition, comm));
+        distributed::gather_distances(distances, partition, comm, result);
+        return result;
+    }
+};
@@ -1,14 +1,14 @@
 #include "task.hpp"
+#include "../common/dijkstra.hpp"
 #include "cpp.hpp"
 #include "openmp.hpp"
 
 int main(int argc, char* argv[]) {
-    Impl impl{delta_stepping_openmp, "OpenMP"};
-    Task task({impl});
-    // Task task({Impl{delta_stepping_cpp, "C++ W/O SET"}, impl});
-    task.init(argc, argv);
-    for (int i = 0; i < 10; i++) {
-        task.run();
+    Impl impl{prepare_labeled<BasicDeltaSteppingOpenMP>, "OpenMP", "openmp"};
+    Task task({impl, Impl{prepare<DeltaSteppingCpp>, "C++", "cpp"}, Impl{prepare_dijkstra, "Dijkstra", "dijkstra", false}});
+    int status = task.init(argc, argv);
+    if (status != 0) {
+        return status == Task::DONE ? 0 : status;
     }
-    return 0;
+    return task.benchmark();
 } 
\ No newline at end of file
@@ -1,213 +1,350 @@
-#include <chrono>
+#include <algorithm>
+#include <climits>
+#include <tuple>
+#include <type_traits>
 #include <vector>
 #include <omp.h>
 #include "../common/graph.hpp"
+#include "../common/engine.hpp"
+#include "../common/atomics.hpp"
+#include "../common/paths.hpp"
+#include "buckets.hpp"
 
-class OpenMPBucket {
-private:
-    int *data;
-    int size;
-public:
-    OpenMPBucket() : size(0) {
-        data = nullptr;
+// Отрезок списка смежности [begin, end) вершины с расстоянием dist
+struct EdgeSegment {
+    int vertex;
+    int dist;
+    size_t begin;
+    size_t end;
+};
+
+// Списки смежности длиннее edge_chunk ребер режутся на отрезки такой
+// длины и раздаются с кражей работы; поток забирает отрезки порциями по
+// segment_grain. Короткие списки релаксируются сразу при обходе фронта
+constexpr size_t edge_chunk = 256;
+constexpr size_t segment_grain = 16;
+
+// Локальное состояние потока: собственные ведра с запросами на релаксацию,
+// список вершин, осевших в текущем ведре, и очередь отрезков ребер фазы. Выравнивание исключает
+// ложное разделение кэш-линий между потоками.
+// Ведра хранятся по кругу (см. cyclic_bucket_count): ведро с номером b
+// лежит в ячейке b % bins.size(), номера ведер снаружи — настоящие.
+struct alignas(64) OpenMPThreadState {
+    std::vector<std::vector<int>> bins;
+    std::vector<int> settled;
+    std::vector<EdgeSegment> segments;
+    size_t next_segment = 0; // первый не взятый отрезок, общий для хозяина и воров
+    size_t lowest = 0; // все ведра с меньшим номером пусты
+
+    void push(int bucket, int vertex) {
+        bins[bucket % bins.size()].push_back(vertex);
+        lowest = std::min(lowest, static_cast<size_t>(bucket));
     }
 
-    OpenMPBucket(int size) : size(size) {
-        data = new int[size];
-        for (int i = 0; i < size; i++) {
-            data[i] = 0;
+    // Ближайшее непустое ведро не раньше current, SIZE_MAX — все пусты
+    size_t first_nonempty(size_t current) {
+        size_t end = current + bins.size();
+        lowest = std::max(lowest, current);
+        while (lowest < end && bins[lowest % bins.size()].empty()) {
+            ++lowest;
         }
+        return lowest < end ? lowest : SIZE_MAX;
     }
 
-    void insert(int index) {
-        data[index] = 1;
+    size_t bin_size(size_t bucket) const {
+        return bins[bucket % bins.size()].size();
     }
 
-    void erase(int index) {
-        data[index] = 0;
+    std::vector<int>& bin(size_t bucket) {
+        return bins[bucket % bins.size()];
     }
 
-    bool empty() {
-        bool is_empty = true;
-        for (int i = 0; i < size; i++) {
-            if (data[i] == 1) {
-                is_empty = false;
-            }
+    void add_edges(int vertex, int dist, size_t begin, size_t end) {
+        for (; begin < end; begin += edge_chunk) {
+            segments.push_back({vertex, dist, begin, std::min(begin + edge_chunk, end)});
         }
-        return is_empty;
     }
 
-    void union_with(const OpenMPBucket& other) {
-        for (int i = 0; i < size; i++) {
-            data[i] |= other.data[i];
+    // Порция отрезков [first, last); false, если очередь исчерпана
+    bool take(size_t& first, size_t& last) {
+        first = __atomic_fetch_add(&next_segment, segment_grain, __ATOMIC_RELAXED);
+        if (first >= segments.size()) {
+            return false;
         }
+        last = std::min(first + segment_grain, segments.size());
+        return true;
     }
+};
 
-    void clear() {
-        for (int i = 0; i < size; i++) {
-            data[i] = 0;
-        }
-    }
+// Перенос ведра bucket из всех потоков в общий фронт.
+// Вызывается всеми потоками команды; возвращает размер нового фронта.
+inline size_t gather_bucket(OpenMPThreadState& state, size_t bucket, std::vector<int>& frontier, size_t& frontier_size) {
+    #pragma omp single
+    frontier_size = 0;
 
-    int* get_vertices(int& count) {
-        int vertices_count = 0;
-        for (int i = 0; i < size; i++) {
-            if (data[i] == 1) {
-                #pragma omp atomic
-                vertices_count++;
-            }
-        }
-        count = vertices_count;
-
-        int *current_vertices = new int[vertices_count];
-        vertices_count = 0;
-        for (int i = 0; i < size; i++) {
-            if (data[i] == 1) {
-                current_vertices[vertices_count] = i;
-                vertices_count++;
-            }
-        }
+    size_t count = state.bin_size(bucket);
+    size_t position;
+    #pragma omp atomic capture
+    { position = frontier_size; frontier_size += count; }
 
-        return current_vertices;
+    #pragma omp barrier
+    #pragma omp single
+    if (frontier.size() < frontier_size) {
+        frontier.resize(frontier_size);
     }
-};
 
-void relax_openmp(
+    if (count > 0) {
+        std::vector<int>& bin = state.bin(bucket);
+        std::copy(bin.begin(), bin.end(), frontier.begin() + position);
+        bin.clear();
+    }
+    #pragma omp barrier
+    return frontier_size;
+}
+
+// Релаксация ребер [begin, end) вершины u с расстоянием dist_u;
+// Label — int или PackedLabel, как у BasicDeltaSteppingOpenMP
+template <typename Label>
+inline void relax_openmp(
     int u,
-    int v,
-    int weight,
-    int *distances,
-    OpenMPBucket *buckets,
-    int delta
+    int dist_u,
+    size_t begin,
+    size_t end,
+    const int* targets,
+    const int* weights,
+    Label* labels,
+    int delta,
+    OpenMPThreadState& state
+    SSSP_COUNT(, ThreadWork& counted)
 ) {
-    int old_bucket = (distances[v] == INF) ? -1 : distances[v] / delta;
-    
-    #pragma omp atomic compare
-    if (distances[v] > distances[u] + weight) {
-        distances[v] = distances[u] + weight;
+    SSSP_COUNT(counted.relax_attempts += end - begin);
+    for (size_t e = begin; e < end; ++e) {
+        int v = targets[e];
+        int new_distance = dist_u + weights[e];
+        int old_distance = label_distance(__atomic_load_n(&labels[v], __ATOMIC_RELAXED));
+        if (new_distance < old_distance && atomic_relax(&labels[v], make_label<Label>(new_distance, u))) {
+            SSSP_COUNT(++counted.relax_success; counted.reinsertions += old_distance < INF);
+            state.push(new_distance / delta, v);
+        }
     }
+}
 
-    int new_bucket = distances[v] / delta;
-    if (old_bucket != -1) {
-        buckets[old_bucket].erase(v);
+// Релаксация отрезков, собранных потоками команды: сначала своя очередь,
+// затем кража порций из очередей остальных потоков. Очереди не растут во
+// время обхода, поэтому исчерпанная очередь больше не проверяется, а время
+// фазы ограничено числом ребер на поток плюс одна порция, а не степенью
+// самой крупной вершины фронта. Вызывается всеми потоками команды.
+template <typename Label>
+inline void relax_segments(
+    std::vector<OpenMPThreadState>& states,
+    const int* targets,
+    const int* weights,
+    Label* labels,
+    int delta
+    SSSP_COUNT(, ThreadWork& counted)
+) {
+    int self = omp_get_thread_num();
+    int threads = omp_get_num_threads();
+    OpenMPThreadState& state = states[self];
+    for (int i = 0; i < threads; ++i) {
+        OpenMPThreadState& victim = states[(self + i) % threads];
+        size_t first;
+        size_t last;
+        while (victim.take(first, last)) {
+            for (size_t j = first; j < last; ++j) {
+                const EdgeSegment& segment = victim.segments[j];
+                relax_openmp(segment.vertex, segment.dist, segment.begin, segment.end, targets, weights, labels, delta, state SSSP_COUNT(, counted));
+            }
+        }
     }
-    buckets[new_bucket].insert(v);
+    #pragma omp barrier
 }
 
-std::vector<int> delta_stepping_openmp(const std::vector<std::vector<std::pair<int, int>>>& adj_matrix, int source, int delta, std::chrono::duration<double>& duration) {
-    int max_edge_weight = 100;
-    int num_vertices = adj_matrix.size();
-    
-    int *distances = new int[num_vertices];
-    for (int i = 0; i < num_vertices; i++) {
-        distances[i] = INF;
-    }
-    distances[source] = 0;
+// Параллельный дельта-шаг на разреженной смежности.
+// Потоки складывают успешные релаксации в свои локальные ведра, следующее
+// ведро выбирается редукцией минимума по потокам, а его содержимое
+// собирается в общий фронт. Память O(V + E), работа O(числа релаксаций).
+// Ребра фазы раздаются отрезками с кражей работы (relax_segments), так что
+// вершины-хабы степенных графов не задерживают фазу на одном потоке.
+// Разделение ребер и все буферы готовятся один раз при подготовке.
+// Label — int (только расстояния) или PackedLabel (расстояние с предком
+// в одном слове, см. prepare_labeled)
+template <typename Label>
+class BasicDeltaSteppingOpenMP : public SsspEngine {
+    CSRGraph graph;
+    CSRGraph light_graph;
+    CSRGraph heavy_graph;
+    int delta;
+    size_t bucket_count;
+    std::vector<Label> labels;
+    // Расстояние, с которым легкие ребра вершины уже релаксированы:
+    // повторные копии вершины во фронте с тем же расстоянием пропускаются
+    std::vector<int> relaxed_distance;
+    std::vector<int> settled_bucket;
+    std::vector<int> frontier;
+    std::vector<OpenMPThreadState> states;
+    std::vector<int> distances;
+    std::vector<int> parent;
 
-    int buckets_size = (max_edge_weight / delta + 1) * 3;
-    OpenMPBucket *buckets = new OpenMPBucket[buckets_size];
-    for (int i = 0; i < buckets_size; i++) {
-        buckets[i] = OpenMPBucket(num_vertices);
-    }
-    buckets[0].insert(source);
-
-    int **light_adj_matrix = new int*[num_vertices];
-    int **heavy_adj_matrix = new int*[num_vertices];
-    for (int i = 0; i < num_vertices; i++) {
-        light_adj_matrix[i] = new int[num_vertices];
-        heavy_adj_matrix[i] = new int[num_vertices];
-        for (int j = 0; j < num_vertices; j++) {
-            light_adj_matrix[i][j] = INF;
-            heavy_adj_matrix[i][j] = INF;
+public:
+    BasicDeltaSteppingOpenMP(const CSRGraph& graph, const EngineOptions& options)
+        : graph(graph), delta(options.delta), labels(graph.get_vertices()),
+          relaxed_distance(graph.get_vertices()), settled_bucket(graph.get_vertices()),
+          frontier(graph.get_vertices()), states(omp_get_max_threads()) {
+        if (delta <= 0) {
+            throw std::invalid_argument("Delta must be positive");
         }
-
-        for (const auto& edge : adj_matrix[i]) {
-            if (edge.second < delta) {
-                light_adj_matrix[i][edge.first] = edge.second;
-            } else {
-                heavy_adj_matrix[i][edge.first] = edge.second;
-            }
+        bucket_count = cyclic_bucket_count(graph, delta);
+        std::tie(light_graph, heavy_graph) = graph.split_by_weight(delta);
+        for (OpenMPThreadState& state : states) {
+            state.bins.resize(bucket_count);
         }
     }
 
+    SSSP_COUNT(WorkCounters* counters() override { return &work; })
 
-    if (source < 0 || source >= num_vertices) {
-        throw std::out_of_range("Source vertex is out of range");
-    }
-    if (delta <= 0) {
-        throw std::invalid_argument("Delta must be positive");
+    const std::vector<int>* parents() override {
+        return std::is_same_v<Label, int> ? nullptr : &parent;
     }
 
-    #ifdef OPENMP_GPU
-    #pragma omp target data map(distances[:num_vertices], buckets[:buckets_size], light_adj_matrix[:num_vertices][:num_vertices], heavy_adj_matrix[:num_vertices][:num_vertices])
-    #endif
-    {
-        auto start = std::chrono::high_resolution_clock::now();
-        for (int current_bucket_num = 0; current_bucket_num < buckets_size; ++current_bucket_num) {
-            OpenMPBucket SBucket(num_vertices);
-            while (!buckets[current_bucket_num].empty()) {
-                OpenMPBucket current_bucket = buckets[current_bucket_num];
-                SBucket.union_with(current_bucket);
-                buckets[current_bucket_num] = OpenMPBucket(num_vertices);
-
-                int current_vertices_count;
-                int *current_vertices_data = current_bucket.get_vertices(current_vertices_count);
-
-                #ifdef OPENMP_GPU
-                #pragma omp target update to(buckets[:buckets_size])
-                #pragma omp target teams distribute parallel for collapse(2)
-                #else
-                #pragma omp parallel for collapse(2)
-                #endif
-                for (int i = 0; i < current_vertices_count; i++) {
-                    for (int j = 0; j < num_vertices; j++) {
-                        int u = current_vertices_data[i];
-                        int v = j;
-                        int weight = light_adj_matrix[u][v];
-
-                        if (distances[v] > distances[u] + weight) {
-                            relax_openmp(u, v, weight, distances, buckets, delta);
-                        }
+    const std::vector<int>& solve(int source) override {
+        check_source(graph, source);
+        const size_t* light_offsets = light_graph.offsets();
+        const int* light_targets = light_graph.targets();
+        const int* light_weights = light_graph.weights();
+        const size_t* heavy_offsets = heavy_graph.offsets();
+        const int* heavy_targets = heavy_graph.targets();
+        const int* heavy_weights = heavy_graph.weights();
+        int delta = this->delta;
+
+        std::fill(labels.begin(), labels.end(), make_label<Label>(INF, -1));
+        std::fill(relaxed_distance.begin(), relaxed_distance.end(), INF);
+        std::fill(settled_bucket.begin(), settled_bucket.end(), -1);
+        if (states.size() < static_cast<size_t>(omp_get_max_threads())) {
+            states.resize(omp_get_max_threads());
+        }
+        for (OpenMPThreadState& state : states) {
+            state.bins.resize(bucket_count);
+        }
+        Label* labels_ptr = labels.data();
+        int* relaxed_ptr = relaxed_distance.data();
+        int* settled_ptr = settled_bucket.data();
+
+        size_t frontier_size = 1;
+        size_t current_bucket = 0;
+        size_t next_bucket = 0;
+        bool light_pending = false;
+
+        labels[source] = make_label<Label>(0, -1);
+        frontier[0] = source;
+
+        #pragma omp parallel
+        {
+            OpenMPThreadState& state = states[omp_get_thread_num()];
+            SSSP_COUNT(ThreadWork& counted = work.current());
+            state.lowest = 0;
+
+            while (frontier_size > 0) {
+                SSSP_COUNT(if (omp_get_thread_num() == 0) { work.phase(frontier_size); })
+                // Релаксация легких ребер вершин текущего ведра
+                state.segments.clear();
+                state.next_segment = 0;
+                #pragma omp for schedule(dynamic, 64) nowait
+                for (size_t i = 0; i < frontier_size; ++i) {
+                    int u = frontier[i];
+                    int dist_u = label_distance(__atomic_load_n(&labels_ptr[u], __ATOMIC_RELAXED));
+                    if (static_cast<size_t>(dist_u / delta) != current_bucket) {
+                        continue;
+                    }
+                    if (__atomic_exchange_n(&settled_ptr[u], static_cast<int>(current_bucket), __ATOMIC_RELAXED) != static_cast<int>(current_bucket)) {
+                        state.settled.push_back(u);
+                    }
+                    if (__atomic_exchange_n(&relaxed_ptr[u], dist_u, __ATOMIC_RELAXED) == dist_u) {
+                        continue;
+                    }
+                    SSSP_COUNT(counted.light_edges += light_offsets[u + 1] - light_offsets[u]);
+                    if (light_offsets[u + 1] - light_offsets[u] > edge_chunk) {
+                        state.add_edges(u, dist_u, light_offsets[u], light_offsets[u + 1]);
+                    } else {
+                        relax_openmp(u, dist_u, light_offsets[u], light_offsets[u + 1], light_targets, light_weights, labels_ptr, delta, state SSSP_COUNT(, counted));
                     }
                 }
-            }
+                #pragma omp barrier
+                relax_segments(states, light_targets, light_weights, labels_ptr, delta SSSP_COUNT(, counted));
 
-            int current_vertices_count;
-            int *current_vertices_data = SBucket.get_vertices(current_vertices_count);
-
-            #ifdef OPENMP_GPU
-            #pragma omp target update to(buckets[:buckets_size])
-            #pragma omp target teams distribute parallel for collapse(2)
-            #else
-            #pragma omp parallel for collapse(2)
-            #endif
-            for (int i = 0; i < current_vertices_count; i++) {
-                for (int j = 0; j < num_vertices; j++) {
-                    int u = current_vertices_data[i];
-                    int v = j;
-                    int weight = heavy_adj_matrix[u][v];
-
-                    if (distances[v] > distances[u] + weight) {
-                        relax_openmp(u, v, weight, distances, buckets, delta);
+                // Если легкие ребра вернули вершины в текущее ведро — новая фаза
+                #pragma omp single
+                light_pending = false;
+                if (state.bin_size(current_bucket) > 0) {
+                    #pragma omp atomic write
+                    light_pending = true;
+                }
+                #pragma omp barrier
+                if (light_pending) {
+                    gather_bucket(state, current_bucket, frontier, frontier_size);
+                    continue;
+                }
+
+                // Ведро опустело: релаксация тяжелых ребер осевших в нем вершин
+                #pragma omp single
+                frontier_size = 0;
+                size_t position;
+                size_t count = state.settled.size();
+                #pragma omp atomic capture
+                { position = frontier_size; frontier_size += count; }
+                #pragma omp barrier
+                #pragma omp single
+                if (frontier.size() < frontier_size) {
+                    frontier.resize(frontier_size);
+                }
+                std::copy(state.settled.begin(), state.settled.end(), frontier.begin() + position);
+                state.settled.clear();
+                #pragma omp barrier
+
+                state.segments.clear();
+                state.next_segment = 0;
+                #pragma omp for schedule(dynamic, 64) nowait
+                for (size_t i = 0; i < frontier_size; ++i) {
+                    int u = frontier[i];
+                    int dist_u = label_distance(__atomic_load_n(&labels_ptr[u], __ATOMIC_RELAXED));
+                    SSSP_COUNT(counted.heavy_edges += heavy_offsets[u + 1] - heavy_offsets[u]);
+                    if (heavy_offsets[u + 1] - heavy_offsets[u] > edge_chunk) {
+                        state.add_edges(u, dist_u, heavy_offsets[u], heavy_offsets[u + 1]);
+                    } else {
+                        relax_openmp(u, dist_u, heavy_offsets[u], heavy_offsets[u + 1], heavy_targets, heavy_weights, labels_ptr, delta, state SSSP_COUNT(, counted));
                     }
                 }
+                #pragma omp barrier
+                relax_segments(states, heavy_targets, heavy_weights, labels_ptr, delta SSSP_COUNT(, counted));
+
+                // Следующее ведро — минимальное непустое по всем потокам
+                #pragma omp single
+                next_bucket = SIZE_MAX;
+                size_t local_next = state.first_nonempty(current_bucket);
+                if (local_next != SIZE_MAX) {
+                    #pragma omp critical
+                    next_bucket = std::min(next_bucket, local_next);
+                }
+                #pragma omp barrier
+                if (next_bucket == SIZE_MAX) {
+                    #pragma omp single
+                    frontier_size = 0;
+                    break;
+                }
+                size_t bucket = next_bucket;
+                #pragma omp single
+                current_bucket = bucket;
+                gather_bucket(state, bucket, frontier, frontier_size);
             }
         }
 
-        auto stop = std::chrono::high_resolution_clock::now();
-        duration = std::chrono::duration_cast<std::chrono::duration<double>>(stop - start);
-    }
-
-    std::vector<int> result(distances, distances + num_vertices);
-
-    delete[] distances;
-    delete[] buckets;
-    for (int i = 0; i < num_vertices; i++) {
-        delete[] light_adj_matrix[i];
-        delete[] heavy_adj_matrix[i];
+        if constexpr (std::is_same_v<Label, int>) {
+            return labels;
+        } else {
+            unpack_labels(labels.data(), graph.get_vertices(), distances, parent);
+            return distances;
+        }
     }
-    delete[] light_adj_matrix;
-    delete[] heavy_adj_matrix;
+};
 
-    return result;
-}
+using DeltaSteppingOpenMP = BasicDeltaSteppingOpenMP<int>;
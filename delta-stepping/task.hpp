@@ -1,55 +1,224 @@
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <chrono>
 #include <set>
 #include <iomanip>
 #include "../common/graph.hpp"
+#include "../common/graph_loaders.hpp"
+#include "../common/generators.hpp"
+#include "../common/impl_selection.hpp"
+#include "../common/benchmark.hpp"
+#include "../common/engine.hpp"
+#include "../common/paths.hpp"
+#include "../common/reorder.hpp"
+#include "../common/perf_counter.hpp"
+#include "../common/dynamic_sssp.hpp"
+#include "auto_delta.hpp"
 
 struct Impl {
-    std::vector<int> (*delta_stepping_impl)(const std::vector<std::vector<std::pair<int, int>>>& adj_matrix, int source, int delta, std::chrono::duration<double>& duration);
+    PrepareFn prepare;
     std::string impl_name;
+    std::string key;
+    bool uses_delta = true; // false у Дейкстры: дельта не пробуется и не пишется в результаты
 };
 
 class Task {
     bool should_print_dists = false;
+    bool engine_failed = false; // реализация бросила исключение, замер недействителен
+    bool check_distance_range = false; // (V - 1) * max|w| >= INF, см. distances_may_overflow
+    bool own_rows_only = false; // процесс MPI, кроме 0, см. read_own_rows_only
 public:
+    // Код init: выведена справка, запускать нечего
+    static const int DONE = -1;
+
     Task(std::vector<Impl> impls) : impls(impls) {}
 
-    void run() {
-        std::vector<std::vector<std::pair<int, int>>> adj_matrix = graph.to_adjacency_matrix();
-        std::vector<std::vector<int>> dists(impls.size());
-        int source = 0;
+    // Для процессов MPI, кроме 0 (вызывается до init): бинарный граф не
+    // подкачивается целиком, движок MPI читает только свои строки, а
+    // проверки по всему графу выполняет процесс 0. Дельту auto движок
+    // MPI тоже берет у процесса 0
+    void read_own_rows_only() {
+        own_rows_only = true;
+    }
+
+    // Один запуск всех реализаций, возвращает их времена в секундах
+    std::vector<double> run(bool verbose = true) {
+        std::vector<double> times(impls.size());
+        std::vector<char> failed(impls.size(), 0);
+        misses.assign(impls.size(), -1);
 
-        std::chrono::_V2::system_clock::time_point start;
-        std::chrono::_V2::system_clock::time_point stop;
-        std::vector<int> reference_dist;
+        if (engines.empty()) {
+            prepare_graph();
+            prepare_engines(benchmark::current_threads());
+        }
 
         for (int i = 0; i < impls.size(); i++) {
-            std::chrono::duration<double> duration;
-            dists[i] = impls[i].delta_stepping_impl(adj_matrix, source, delta, duration);
-            std::cout << std::setw(16) << std::left << impls[i].impl_name << "реализация: " << std::fixed << std::setprecision(6) << duration.count() << " секунд" << std::endl;
-            if (reference_dist.empty()) reference_dist = dists[i];
+            const std::vector<int>* dist = nullptr;
+            if (WorkCounters* counters = engines[i]->counters()) {
+                counters->reset();
+            }
+            cache_misses.start();
+            auto start = std::chrono::high_resolution_clock::now();
+            try {
+                if (sources.size() == 1) {
+                    dist = &solve(*engines[i], sources[0]);
+                } else {
+                    engines[i]->solve_batch(sources, dists[i]);
+                }
+            } catch (const std::exception& e) {
+                // Ошибка одной реализации (например, расстояние не помещается
+                // в int) не прерывает остальные, но запуск считается неудачным
+                cache_misses.stop();
+                std::cout << std::setw(18) << std::left << impls[i].impl_name << "ошибка: " << e.what() << std::endl;
+                failed[i] = 1;
+                engine_failed = true;
+                continue;
+            }
+            auto stop = std::chrono::high_resolution_clock::now();
+            misses[i] = cache_misses.stop();
+            times[i] = std::chrono::duration<double>(stop - start).count();
+            // Проверка вне замера, только для графов с путями длиной до INF
+            if (check_distance_range && report_truncated(impls[i], dist ? *dist : dists[i])) {
+                failed[i] = 1;
+                engine_failed = true;
+                continue;
+            }
+            if (!verbose) continue;
+            std::cout << std::setw(18) << std::left << impls[i].impl_name << "реализация: " << std::fixed << std::setprecision(6) << times[i] << " секунд" << std::endl;
+            if (dist && impls.size() > 1) dists[i] = *dist;
+            if (const std::vector<int>* parents = engines[i]->parents()) {
+                // Предки относятся к последнему источнику запроса
+                std::vector<int> last = dist ? *dist : std::vector<int>(dists[i].end() - vertices, dists[i].end());
+                check_paths(impls[i], last, *parents, sources.back());
+            }
         }
 
-        if (impls.size() > 1) {
+        if (impls.size() > 1 && verbose) {
+        int reference = -1;
         for (int i = 0; i < impls.size(); i++) {
+            if (failed[i]) {
+                continue;
+            }
             if (should_print_dists) {
                 std::cout << impls[i].impl_name << " реализация: ";
-                for (int j = 0; j < vertices; j++) {
+                for (size_t j = 0; j < dists[i].size(); j++) {
                     if (dists[i][j] == INF) std::cout << "INF ";
                     else std::cout << dists[i][j] << " ";
                 }
                 std::cout << std::endl;
             }
-            if (dists[i] != reference_dist) {
+            if (reference < 0) {
+                reference = i;
+            } else if (dists[i] != dists[reference]) {
                 std::cout << "Результаты не совпадают" << std::endl;
-                return;
+                return times;
+                }
+            }
+            // Сравнивать есть что, только если без ошибки отработали хотя бы две
+            if (std::count(failed.begin(), failed.end(), 0) > 1) {
+                std::cout << "Результаты совпадают" << std::endl;
+            }
+        }
+        return times;
+    }
+
+    // Серия замеров: прогрев и повторы для каждого размера графа,
+    // порядка вершин и числа потоков, итоговая статистика и сохранение результатов
+    int benchmark() {
+        std::vector<benchmark::Record> records;
+        if (update_batch > 0) {
+            try {
+                records = dynamic_sssp::benchmark_updates(csr, graph_name, 0, update_batch, benchmark_options.repeat, generator.seed);
+            } catch (const std::exception& e) {
+                std::cerr << "Ошибка в динамическом режиме: " << e.what() << std::endl;
+                return 1;
+            }
+            return save_records(records);
+        }
+        std::vector<int> sizes = benchmark_options.sizes;
+        if (sizes.empty()) {
+            sizes.push_back(vertices);
+        }
+
+        for (int size : sizes) {
+            if (size != vertices) {
+                generator.vertices = size;
+                try {
+                    generate_graph(false);
+                } catch (const std::exception& e) {
+                    std::cerr << "Ошибка при создании графа: " << e.what() << std::endl;
+                    return 1;
+                }
+            }
+            for (const std::string& method : reorder_methods) {
+                reorder_method = method;
+                bool prepared = false;
+                for (int threads : benchmark_options.thread_counts()) {
+                    benchmark::set_threads(threads);
+                    // Дельта auto и probe зависит от числа потоков, поэтому
+                    // движки готовятся заново для каждого; с заданной дельтой — один раз
+                    if (!prepared || !delta_mode.empty()) {
+                        try {
+                            if (!prepared) {
+                                prepare_graph();
+                            }
+                            prepare_engines(threads);
+                        } catch (const std::exception& e) {
+                            std::cerr << "Ошибка при подготовке реализаций: " << e.what() << std::endl;
+                            return 1;
+                        }
+                        prepared = true;
+                    }
+                    for (int i = 0; i < benchmark_options.warmup && !engine_failed; ++i) {
+                        run(false);
+                    }
+                    std::vector<std::vector<double>> samples(impls.size());
+                    std::vector<std::vector<double>> miss_samples(impls.size());
+                    for (int i = 0; i < benchmark_options.repeat && !engine_failed; ++i) {
+                        std::vector<double> times = run();
+                        for (size_t j = 0; j < impls.size(); ++j) {
+                            samples[j].push_back(times[j]);
+                            miss_samples[j].push_back(static_cast<double>(misses[j]));
+                        }
+                    }
+                    if (engine_failed) {
+                        // Ошибка уже выведена в run(), замер недействителен
+                        return 1;
+                    }
+                    for (size_t j = 0; j < impls.size(); ++j) {
+                        benchmark::Record record;
+                        record.impl_name = impls[j].impl_name;
+                        record.key = impls[j].key;
+                        record.graph = graph_name;
+                        record.vertices = csr.get_vertices();
+                        record.edges = csr.get_edges_count();
+                        record.threads = threads;
+                        record.sources = static_cast<int>(sources.size());
+                        record.delta = impls[j].uses_delta ? engine_options.delta : 0;
+                        record.prepare = prepare_times[j];
+                        record.reorder = reorder_method;
+                        record.reorder_time = reorder_time;
+                        if (cache_misses.available()) {
+                            record.llc_misses = static_cast<long long>(benchmark::Stats::compute(miss_samples[j]).median);
+                        }
+                        // Счетчики работы последнего замеренного запуска
+                        if (WorkCounters* counters = engines[j]->counters()) {
+                            record.has_counters = true;
+                            record.counters = *counters;
+                        }
+                        record.samples = samples[j];
+                        record.stats = benchmark::Stats::compute(samples[j]);
+                        benchmark::print_record(record);
+                        records.push_back(record);
+                    }
                 }
             }
-            std::cout << "Результаты совпадают" << std::endl;
         }
+
+        return save_records(records);
     }
 
     int init(int argc, char* argv[]) {
@@ -59,31 +228,67 @@ public:
 
         for (int i = 1; i < argc; ++i) {
             std::string arg = argv[i];
-            if (arg == "--vertices" && i + 1 < argc) {
-                vertices = std::atoi(argv[++i]);
-                if (vertices <= 0) {
-                    std::cerr << "Ошибка: количество вершин должно быть положительным числом" << std::endl;
-                    return 1;
-                }
-            } else if (arg == "--prob" && i + 1 < argc) {
-                edge_probability = std::atof(argv[++i]);
-                if (edge_probability <= 0 || edge_probability > 1) {
-                    std::cerr << "Ошибка: вероятность ребра должна быть в диапазоне (0, 1]" << std::endl;
+            int generator_arg = generator.parse_arg(i, argc, argv);
+            if (generator_arg == 0) {
+                generator_arg = benchmark_options.parse_arg(i, argc, argv);
+            }
+            if (generator_arg < 0) {
+                return 1;
+            } else if (generator_arg > 0) {
+                continue;
+            } else if (arg == "--impl" && i + 1 < argc) {
+                impl_keys = argv[++i];
+            } else if (arg == "--format" && i + 1 < argc) {
+                try {
+                    graph_format = graph_loaders::parse_format(argv[++i]);
+                } catch (const std::exception&) {
+                    std::cerr << "Ошибка: неизвестный формат графа " << argv[i] << std::endl;
                     return 1;
                 }
             } else if (arg == "--save") {
                 should_save_graph = true;
+            } else if (arg == "--verify") {
+                verify_checksum = true;
             } else if (arg == "--delta" && i + 1 < argc) {
-                delta = std::atoi(argv[++i]);
+                std::string value = argv[++i];
+                if (value == "auto" || value == "probe") {
+                    delta_mode = value;
+                } else {
+                    delta_mode.clear();
+                    engine_options.delta = std::atoi(value.c_str());
+                }
                 // if (delta <= 0) {
                 //     std::cerr << "Ошибка: дельта должна быть положительным числом" << std::endl;
                 //     return 1;
                 // }
+            } else if (arg == "--sources" && i + 1 < argc) {
+                source_count = std::atoi(argv[++i]);
+                if (source_count <= 0) {
+                    std::cerr << "Ошибка: количество источников должно быть положительным числом" << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--updates" && i + 1 < argc) {
+                update_batch = std::atoi(argv[++i]);
+                if (update_batch <= 0) {
+                    std::cerr << "Ошибка: размер пакета изменений должен быть положительным числом" << std::endl;
+                    return 1;
+                }
+            } else if (arg == "--paths") {
+                engine_options.parents = true;
+            } else if (arg == "--heap" && i + 1 < argc) {
+                engine_options.heap = argv[++i];
+            } else if (arg == "--reorder" && i + 1 < argc) {
+                try {
+                    reorder_methods = reordering::parse_methods(argv[++i]);
+                } catch (const std::exception&) {
+                    std::cerr << "Ошибка: неизвестный порядок вершин " << argv[i] << std::endl;
+                    return 1;
+                }
             } else if (arg == "--print") {
                 should_print_dists = true;
             } else if (arg == "--help") {
                 print_usage(argv[0]);
-                return 0;
+                return DONE;
             } else if (arg[0] != '-') {
                 graph_file = arg;
             } else {
@@ -93,42 +298,228 @@ public:
             }
         }
 
+        if (!select_impls(impls, impl_keys)) {
+            return 1;
+        }
+
+        if (!graph_file.empty() && !benchmark_options.sizes.empty()) {
+            std::cerr << "Ошибка: --sizes применимо только к случайному графу" << std::endl;
+            return 1;
+        }
+
         if (!graph_file.empty()) {
             try {
-                graph.load_from_file(graph_file);
+                csr = graph_loaders::load_graph(graph_file, graph_format, !own_rows_only, verify_checksum);
+                graph_name = graph_file;
                 std::cout << "Граф загружен из файла: " << graph_file << std::endl;
             } catch (const std::exception& e) {
                 std::cerr << "Ошибка при загрузке графа: " << e.what() << std::endl;
                 return 1;
             }
+            vertices = csr.get_vertices();
+            std::cout << "Количество вершин: " << csr.get_vertices()
+                    << ", количество ребер: " << csr.get_edges_count() << std::endl;
         } else {
-            std::cout << "Создание случайного графа, количество вершин: " << vertices << ", вероятность ребра: " << edge_probability << std::endl;
-            graph.create_random_graph(vertices, edge_probability);
-            if (should_save_graph) {
-                graph_file = "graph.txt";
-                graph.save_to_file(graph_file);
-                std::cout << "Граф сохранен в файл: " << graph_file << std::endl;
+            if (!benchmark_options.sizes.empty()) {
+                generator.vertices = benchmark_options.sizes.front();
+            }
+            try {
+                generate_graph(should_save_graph);
+            } catch (const std::exception& e) {
+                std::cerr << "Ошибка при создании графа: " << e.what() << std::endl;
+                return 1;
             }
         }
-        vertices = graph.get_vertices();
-        std::cout << "Количество вершин: " << graph.get_vertices()
-                << ", количество ребер: " << graph.get_edges().size() << std::endl;
         return 0;
     }
 
 private:
-    int vertices = 100;
-    double edge_probability = 0.5;
-    int delta = 10;
+    int vertices = 0;
+    graph_generators::GeneratorOptions generator{100, 0.5};
+    EngineOptions engine_options;
+    graph_loaders::Format graph_format = graph_loaders::Format::Auto;
+    bool verify_checksum = false;
     Graph graph;
+    CSRGraph csr;
     std::vector<Impl> impls;
+    std::string impl_keys;
+    benchmark::Options benchmark_options;
+    std::string graph_name;
+    std::vector<EngineHandle> engines;
+    std::vector<double> prepare_times;
+    int source_count = 1;
+    int update_batch = 0;
+    std::string delta_mode;  // пусто — дельта из --delta, иначе auto или probe
+    std::vector<int> sources;
+    std::vector<std::vector<int>> dists;
+    std::vector<std::string> reorder_methods{"none"};
+    std::string reorder_method = "none";
+    double reorder_time = 0;
+    CacheMissCounter cache_misses;
+    std::vector<long long> misses;
+    CSRGraph graph_to_solve;                         // csr после перенумерации
+    std::shared_ptr<const std::vector<int>> new_id;  // пусто без перенумерации
+
+    // Перенумерация и проверка текущего графа, общие для всех чисел
+    // потоков. Перенумерация одна на все реализации; источники и
+    // расстояния остаются в исходных номерах
+    void prepare_graph() {
+        check_distance_range = !own_rows_only && distances_may_overflow(csr);
+        reorder_time = 0;
+        graph_to_solve = csr;
+        new_id.reset();
+        if (reorder_method != "none") {
+            auto start = std::chrono::high_resolution_clock::now();
+            new_id = std::make_shared<const std::vector<int>>(reordering::compute_new_ids(csr, reorder_method));
+            graph_to_solve = reordering::relabel(csr, *new_id);
+            auto stop = std::chrono::high_resolution_clock::now();
+            reorder_time = std::chrono::duration<double>(stop - start).count();
+            std::cout << "Перенумерация вершин (" << reorder_method << "): " << std::fixed << std::setprecision(6) << reorder_time << " секунд" << std::endl;
+        }
+    }
+
+    // Дельта auto или probe для threads потоков по перенумерованному графу.
+    // Проба идет на первой выбранной реализации дельта-шага
+    void choose_delta(int threads) {
+        if (!own_rows_only) {
+            engine_options.delta = heuristic_delta(graph_to_solve, threads);
+        }
+        if (delta_mode == "probe") {
+            auto probed = std::find_if(impls.begin(), impls.end(), [](const Impl& impl) { return impl.uses_delta; });
+            if (probed != impls.end()) {
+                try {
+                    engine_options.delta = probe_delta(graph_to_solve, probed->prepare, engine_options, engine_options.delta);
+                } catch (const UnsupportedGraph&) {
+                    // Граф не для дельта-шага: реализация будет пропущена при подготовке
+                }
+            }
+        }
+        std::cout << "Выбрана дельта: " << engine_options.delta << " (" << delta_mode << ", потоков: " << threads << ")" << std::endl;
+    }
+
+    // Подготовка движков к текущему графу (после prepare_graph) для
+    // threads потоков; время подготовки не входит в замеры запросов и
+    // выводится отдельно
+    void prepare_engines(int threads) {
+        engines.clear();
+        prepare_times.clear();
+        // Источники равномерно по номерам вершин, первый — вершина 0
+        sources.resize(std::min(source_count, vertices));
+        for (size_t i = 0; i < sources.size(); ++i) {
+            sources[i] = static_cast<int>(i * vertices / sources.size());
+        }
+        dists.assign(impls.size(), std::vector<int>(sources.size() * vertices));
+        if (!delta_mode.empty()) {
+            choose_delta(threads);
+        }
+
+        for (size_t i = 0; i < impls.size();) {
+            const Impl& impl = impls[i];
+            auto start = std::chrono::high_resolution_clock::now();
+            EngineHandle engine;
+            try {
+                engine = impl.prepare(graph_to_solve, engine_options);
+            } catch (const UnsupportedGraph& e) {
+                // Граф не для этой реализации: остальные запускаются без нее
+                std::cout << std::setw(18) << std::left << impl.impl_name << "пропущена: " << e.what() << std::endl;
+                impls.erase(impls.begin() + i);
+                continue;
+            }
+            ++i;
+            if (new_id) {
+                engine = std::make_unique<reordering::ReorderedEngine>(std::move(engine), new_id);
+            }
+            engines.push_back(std::move(engine));
+            auto stop = std::chrono::high_resolution_clock::now();
+            prepare_times.push_back(std::chrono::duration<double>(stop - start).count());
+            std::cout << std::setw(18) << std::left << impl.impl_name << "подготовка: " << std::fixed << std::setprecision(6) << prepare_times.back() << " секунд" << std::endl;
+        }
+        if (impls.empty()) {
+            throw std::runtime_error("No selected implementation supports this graph");
+        }
+        dists.resize(impls.size());
+    }
+
+    // Расстояние, которое не поместилось в int и осталось INF; result —
+    // расстояния от всех источников запроса подряд
+    bool report_truncated(const Impl& impl, const std::vector<int>& result) {
+        for (size_t s = 0; s < sources.size() && (s + 1) * vertices <= result.size(); ++s) {
+            int v = find_truncated_distance(csr, result.data() + s * vertices);
+            if (v >= 0) {
+                std::cout << std::setw(18) << std::left << impl.impl_name << "ошибка: расстояние от " << sources[s]
+                          << " до " << v << " не помещается в int" << std::endl;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Проверка дерева кратчайших путей (--paths) и путь до самой дальней
+    // достижимой вершины; в замер запроса не входит
+    void check_paths(const Impl& impl, const std::vector<int>& dist, const std::vector<int>& parents, int source) {
+        int errors = check_tree(csr, dist, parents, source);
+        std::cout << std::setw(18) << std::left << impl.impl_name << "дерево путей: ";
+        if (errors > 0) {
+            std::cout << "ошибки в " << errors << " вершинах" << std::endl;
+            return;
+        }
+        int farthest = source;
+        for (int v = 0; v < vertices; ++v) {
+            if (dist[v] < INF && dist[v] > dist[farthest]) {
+                farthest = v;
+            }
+        }
+        std::vector<int> path;
+        extract_path(parents, source, farthest, path);
+        std::cout << "корректно, путь " << source << " -> " << farthest << " из " << path.size() - 1
+                  << " ребер, длина " << dist[farthest] << std::endl;
+    }
+
+    // Сохранение результатов в файл из --output
+    int save_records(const std::vector<benchmark::Record>& records) {
+        try {
+            benchmark_options.save(records);
+        } catch (const std::exception& e) {
+            std::cerr << "Ошибка при сохранении результатов: " << e.what() << std::endl;
+            return 1;
+        }
+        if (!benchmark_options.output.empty()) {
+            std::cout << "Результаты замеров сохранены в файл: " << benchmark_options.output << std::endl;
+        }
+        return 0;
+    }
+
+    void generate_graph(bool should_save_graph) {
+        std::cout << "Создание случайного графа, " << generator.describe() << std::endl;
+        graph = generator.generate();
+        if (should_save_graph) {
+            graph.save_to_file("graph.txt");
+            std::cout << "Граф сохранен в файл: graph.txt" << std::endl;
+        }
+        csr = graph.to_csr();
+        engines.clear();
+        graph_name = generator.describe();
+        vertices = csr.get_vertices();
+        std::cout << "Количество вершин: " << csr.get_vertices()
+                << ", количество ребер: " << csr.get_edges_count() << std::endl;
+    }
 
     void print_usage(const char* program_name) {
         std::cout << "Использование: " << program_name << " [опции] [файл_графа]" << std::endl;
         std::cout << "Опции:" << std::endl;
         std::cout << "  --vertices N    Количество вершин (по умолчанию 1000)" << std::endl;
         std::cout << "  --prob P        Вероятность ребра (по умолчанию 0.3)" << std::endl;
-        std::cout << "  --delta D       Дельта (по умолчанию 10)" << std::endl;
+        std::cout << "  --delta D       Дельта: число, auto (по весам, степени и числу потоков, для каждого числа потоков) или probe (auto с уточнением пробой) (по умолчанию 10)" << std::endl;
+        std::cout << "  --impl K[,K]    Реализации по ключам или all (по умолчанию первая)" << std::endl;
+        std::cout << "  --sources N     Количество источников в запросе (по умолчанию 1)" << std::endl;
+        graph_generators::GeneratorOptions::print_usage();
+        benchmark::Options::print_usage();
+        std::cout << "  --updates N     Динамический режим: --repeat пакетов по N изменений ребер, восстановление против пересчета с нуля" << std::endl;
+        std::cout << "  --paths         Строить дерево кратчайших путей и проверять его" << std::endl;
+        std::cout << "  --heap H        Очередь реализации dijkstra: binary, 4ary, pairing, radix (по умолчанию radix)" << std::endl;
+        std::cout << "  --reorder M,..  Перенумерация вершин: none, degree, bfs, dfs, rcm, gorder (по умолчанию none)" << std::endl;
+        std::cout << "  --format F      Формат файла графа: auto, native, dimacs, mtx, snap, binary (по умолчанию auto)" << std::endl;
+        std::cout << "  --verify        Сверить контрольную сумму бинарного графа при загрузке" << std::endl;
         std::cout << "  --save          Сохранить граф в файл" << std::endl;
         std::cout << "  --print         Вывести расстояния" << std::endl;
         std::cout << "  --help          Показать это сообщение" << std::endl;
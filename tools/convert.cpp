@@ -0,0 +1,69 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include "../common/graph.hpp"
+#include "../common/binary_graph.hpp"
+#include "../common/graph_loaders.hpp"
+
+void print_usage(const char* program_name) {
+    std::cout << "Использование: " << program_name << " [опции] входной_файл [выходной_файл]" << std::endl;
+    std::cout << "Опции:" << std::endl;
+    std::cout << "  --format F      Формат входного файла: auto, native, dimacs, mtx, snap (по умолчанию auto)" << std::endl;
+    std::cout << "  --verify        Проверить бинарный граф (контрольная сумма и структура)" << std::endl;
+    std::cout << "  --help          Показать это сообщение" << std::endl;
+    std::cout << "\nБез --verify граф из входного файла записывается в бинарный формат" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    bool should_verify = false;
+    graph_loaders::Format format = graph_loaders::Format::Auto;
+    std::vector<std::string> files;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc) {
+            try {
+                format = graph_loaders::parse_format(argv[++i]);
+            } catch (const std::exception&) {
+                std::cerr << "Ошибка: неизвестный формат графа " << argv[i] << std::endl;
+                return 1;
+            }
+        } else if (arg == "--verify") {
+            should_verify = true;
+        } else if (arg == "--help") {
+            print_usage(argv[0]);
+            return 0;
+        } else if (arg[0] != '-') {
+            files.push_back(arg);
+        } else {
+            std::cerr << "Неизвестная опция: " << arg << std::endl;
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (files.size() != (should_verify ? 1u : 2u)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    try {
+        auto start = std::chrono::high_resolution_clock::now();
+        if (should_verify) {
+            CSRGraph csr = binary_graph::load(files[0], true);
+            std::cout << "Граф корректен, количество вершин: " << csr.get_vertices()
+                    << ", количество ребер: " << csr.get_edges_count() << std::endl;
+        } else {
+            CSRGraph csr = graph_loaders::load_graph(files[0], format);
+            binary_graph::save(csr, files[1]);
+            std::cout << "Граф записан в файл: " << files[1] << ", количество вершин: " << csr.get_vertices()
+                    << ", количество ребер: " << csr.get_edges_count() << std::endl;
+        }
+        auto stop = std::chrono::high_resolution_clock::now();
+        std::cout << "Время: " << std::chrono::duration<double>(stop - start).count() << " секунд" << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "Ошибка: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}